@@ -6,19 +6,21 @@ class CoroutineController {
     private val controlChannel = Channel<ControlCommand>(Channel.UNLIMITED)
     var isPaused = false
 
-    suspend fun controlledCoroutine() {
-        checkControl()
+    suspend fun controlledCoroutine(onPause: () -> Unit = {}, onResume: () -> Unit = {}) {
+        checkControl(onPause, onResume)
     }
 
-    private suspend fun checkControl() {
+    private suspend fun checkControl(onPause: () -> Unit, onResume: () -> Unit) {
         controlChannel.tryReceive().getOrNull()?.let {
             when (it) {
                 ControlCommand.Pause -> {
                     isPaused = true
+                    onPause()
                     while (controlChannel.receive() != ControlCommand.Resume) {
                         // do nothing
                     }
                     isPaused = false
+                    onResume()
                 }
                 ControlCommand.Resume -> {}
             }
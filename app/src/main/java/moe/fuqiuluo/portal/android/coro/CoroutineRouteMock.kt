@@ -6,19 +6,21 @@ class CoroutineRouteMock {
     private val routeMockChannel = Channel<RouteMockCommand>(Channel.UNLIMITED)
     var isPaused = false
 
-    suspend fun routeMockCoroutine() {
-        checkRouteMockStatus()
+    suspend fun routeMockCoroutine(onPause: () -> Unit = {}, onResume: () -> Unit = {}) {
+        checkRouteMockStatus(onPause, onResume)
     }
 
-    private suspend fun checkRouteMockStatus() {
+    private suspend fun checkRouteMockStatus(onPause: () -> Unit, onResume: () -> Unit) {
         routeMockChannel.tryReceive().getOrNull()?.let {
             when (it) {
                 RouteMockCommand.Pause -> {
                     isPaused = true
+                    onPause()
                     while (routeMockChannel.receive() != RouteMockCommand.Resume) {
                         // do nothing
                     }
                     isPaused = false
+                    onResume()
                 }
                 RouteMockCommand.Resume -> {}
             }
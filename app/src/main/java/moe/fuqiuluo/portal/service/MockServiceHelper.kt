@@ -23,6 +23,7 @@ import moe.fuqiuluo.portal.ext.speed
 import moe.fuqiuluo.portal.ext.reportDuration
 import moe.fuqiuluo.portal.ext.loopBroadcastlocation
 import moe.fuqiuluo.xposed.utils.FakeLoc
+import moe.fuqiuluo.xposed.utils.MockState
 import java.io.File
 
 object MockServiceHelper {
@@ -146,6 +147,7 @@ object MockServiceHelper {
         val rely = Bundle()
         rely.putString("command_id", "stop")
         stopLoopBroadcastLocation()
+        clearStates(locationManager)
         if (locationManager.sendExtraCommand(PROVIDER_NAME, randomKey, rely)) {
             return !isMockStart(locationManager)
         }
@@ -277,6 +279,95 @@ object MockServiceHelper {
         return locationManager.sendExtraCommand(PROVIDER_NAME, randomKey, rely)
     }
 
+    /**
+     * 将整条路线交给Native路线引擎播放，之后位置由系统进程按时间推算，无需逐步move
+     */
+    fun startRoute(
+        locationManager: LocationManager,
+        route: List<Pair<Double, Double>>,
+        speed: Double,
+        speedVariation: Double = 0.0,
+        smoothing: Int = 0
+    ): Boolean {
+        if (!::randomKey.isInitialized) {
+            return false
+        }
+        val points = DoubleArray(route.size * 2)
+        route.forEachIndexed { i, (lat, lon) ->
+            points[i * 2] = lat
+            points[i * 2 + 1] = lon
+        }
+        val rely = Bundle()
+        rely.putString("command_id", "start_route")
+        rely.putDoubleArray("route", points)
+        rely.putDouble("speed", speed)
+        rely.putDouble("speed_variation", speedVariation)
+        rely.putInt("smoothing", smoothing)
+        return locationManager.sendExtraCommand(PROVIDER_NAME, randomKey, rely)
+    }
+
+    fun stopRoute(locationManager: LocationManager): Boolean {
+        if (!::randomKey.isInitialized) {
+            return false
+        }
+        val rely = Bundle()
+        rely.putString("command_id", "stop_route")
+        return locationManager.sendExtraCommand(PROVIDER_NAME, randomKey, rely)
+    }
+
+    /**
+     * 暂停/继续Native路线播放，继续时从暂停处接着走
+     */
+    fun pauseRoute(locationManager: LocationManager, paused: Boolean): Boolean {
+        if (!::randomKey.isInitialized) {
+            return false
+        }
+        val rely = Bundle()
+        rely.putString("command_id", "pause_route")
+        rely.putBoolean("paused", paused)
+        return locationManager.sendExtraCommand(PROVIDER_NAME, randomKey, rely)
+    }
+
+    fun isRouteStart(locationManager: LocationManager): Boolean {
+        if (!::randomKey.isInitialized) {
+            return false
+        }
+        val rely = Bundle()
+        rely.putString("command_id", "is_route_start")
+        if(locationManager.sendExtraCommand(PROVIDER_NAME, randomKey, rely)) {
+            return rely.getBoolean("is_route_start")
+        }
+        return false
+    }
+
+    /**
+     * 一次提交一段规划好的轨迹，传感器Hook按事件时间插值，App更新线程卡顿时输出仍然平滑
+     *
+     * @return 被接受的样本数，失败时为-1
+     */
+    fun submitStates(locationManager: LocationManager, states: List<MockState>, replace: Boolean = true): Int {
+        if (!::randomKey.isInitialized || states.isEmpty()) {
+            return -1
+        }
+        val rely = Bundle()
+        rely.putString("command_id", "submit_states")
+        rely.putByteArray("states", MockState.pack(states))
+        rely.putBoolean("replace", replace)
+        if(locationManager.sendExtraCommand(PROVIDER_NAME, randomKey, rely)) {
+            return rely.getInt("accepted")
+        }
+        return -1
+    }
+
+    fun clearStates(locationManager: LocationManager): Boolean {
+        if (!::randomKey.isInitialized) {
+            return false
+        }
+        val rely = Bundle()
+        rely.putString("command_id", "clear_states")
+        return locationManager.sendExtraCommand(PROVIDER_NAME, randomKey, rely)
+    }
+
     fun setLocation(locationManager: LocationManager, lat: Double, lon: Double): Boolean {
         return updateLocation(locationManager, lat, lon, "=")
     }
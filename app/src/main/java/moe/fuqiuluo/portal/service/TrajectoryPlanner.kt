@@ -0,0 +1,82 @@
+package moe.fuqiuluo.portal.service
+
+import moe.fuqiuluo.xposed.utils.MockState
+import kotlin.math.PI
+import kotlin.math.abs
+import kotlin.math.cos
+import kotlin.math.sin
+
+/**
+ * 摇杆模式的轨迹规划：按当前速度与方向一次规划未来几秒的状态，由系统进程按时间插值，
+ * 速度/方向不变时无需每个tick都跨进程调用
+ *
+ * @param horizonNanos 每次规划的时长
+ * @param stepNanos 规划样本间隔
+ * @param refreshNanos 剩余不足该时长时重新规划
+ */
+class TrajectoryPlanner(
+    private val horizonNanos: Long = 10_000_000_000L,
+    private val stepNanos: Long = 100_000_000L,
+    private val refreshNanos: Long = 2_000_000_000L,
+) {
+    private var plan: List<MockState> = emptyList()
+
+    fun reset() {
+        plan = emptyList()
+    }
+
+    /**
+     * 速度或方向变化、或规划即将用完时需要重新规划
+     */
+    fun needsReplan(now: Long, speed: Double, bearing: Double): Boolean {
+        val first = plan.firstOrNull() ?: return true
+        if (now > plan.last().elapsedRealtimeNanos - refreshNanos) return true
+        if (abs(first.speed - speed) > 0.01) return true
+        val turn = ((bearing - first.bearing) % 360.0 + 540.0) % 360.0 - 180.0
+        return abs(turn) > 1.0
+    }
+
+    /**
+     * 上一次规划在[now]时刻的位置，没有规划时为null
+     */
+    fun positionAt(now: Long): Pair<Double, Double>? {
+        if (plan.isEmpty()) return null
+        val next = plan.indexOfFirst { it.elapsedRealtimeNanos > now }
+        if (next <= 0) {
+            val held = if (next == 0) plan.first() else plan.last()
+            return held.latitude to held.longitude
+        }
+        val a = plan[next - 1]
+        val b = plan[next]
+        val t = (now - a.elapsedRealtimeNanos).toDouble() / (b.elapsedRealtimeNanos - a.elapsedRealtimeNanos)
+        return (a.latitude + (b.latitude - a.latitude) * t) to (a.longitude + (b.longitude - a.longitude) * t)
+    }
+
+    /**
+     * 从([lat], [lon])出发按[speed]米/秒、[bearing]度匀速直行，生成从[now]开始的一段规划
+     */
+    fun plan(now: Long, lat: Double, lon: Double, altitude: Double, speed: Double, bearing: Double): List<MockState> {
+        val mode = when {
+            speed <= 0.0 -> MockState.MODE_IDLE
+            speed < 2.5 -> MockState.MODE_WALK
+            speed < 7.0 -> MockState.MODE_RUN
+            else -> MockState.MODE_VEHICLE
+        }
+        val angle = bearing * PI / 180
+        val states = ArrayList<MockState>((horizonNanos / stepNanos + 1).toInt())
+        var step = 0L
+        while (step * stepNanos <= horizonNanos) {
+            val distance = speed * step * stepNanos / 1e9
+            val newLat = lat + distance * cos(angle) / EARTH_RADIUS * (180 / PI)
+            val newLon = lon + distance * sin(angle) / (EARTH_RADIUS * cos(lat * PI / 180)) * (180 / PI)
+            states.add(MockState(now + step * stepNanos, newLat, newLon, altitude, bearing.toFloat(), speed.toFloat(), mode))
+            step++
+        }
+        plan = states
+        return states
+    }
+
+    companion object {
+        private const val EARTH_RADIUS = 6371000.0
+    }
+}
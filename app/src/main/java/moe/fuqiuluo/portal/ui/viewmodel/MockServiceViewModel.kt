@@ -2,6 +2,7 @@ package moe.fuqiuluo.portal.ui.viewmodel
 
 import android.app.Activity
 import android.location.LocationManager
+import android.os.SystemClock
 import android.util.Log
 import androidx.lifecycle.ViewModel
 import com.tencent.bugly.crashreport.CrashReport
@@ -18,11 +19,11 @@ import moe.fuqiuluo.portal.ext.altitude
 import moe.fuqiuluo.portal.ext.reportDuration
 import moe.fuqiuluo.portal.ext.speed
 import moe.fuqiuluo.portal.service.MockServiceHelper
+import moe.fuqiuluo.portal.service.TrajectoryPlanner
 import moe.fuqiuluo.portal.ui.mock.HistoricalLocation
 import moe.fuqiuluo.portal.ui.mock.HistoricalRoute
 import moe.fuqiuluo.portal.ui.mock.Rocker
 import moe.fuqiuluo.xposed.utils.FakeLoc
-import net.sf.geographiclib.Geodesic
 
 class MockServiceViewModel : ViewModel() {
     lateinit var rocker: Rocker
@@ -32,6 +33,7 @@ class MockServiceViewModel : ViewModel() {
     var routeStage = 0
     val rockerCoroutineController = CoroutineController()
     val routeMockCoroutine = CoroutineRouteMock()
+    private val trajectoryPlanner = TrajectoryPlanner()
 
     var isRouteStart = false
 
@@ -57,13 +59,17 @@ class MockServiceViewModel : ViewModel() {
             val applicationContext = activity.applicationContext
             rockerJob = GlobalScope.launch {
                 do {
-                    rockerCoroutineController.controlledCoroutine()
+                    // 松开摇杆时清除规划，位置停在当前插值处
+                    rockerCoroutineController.controlledCoroutine(
+                        onPause = {
+                            trajectoryPlanner.reset()
+                            MockServiceHelper.clearStates(locationManager!!)
+                        }
+                    )
                     delay(delayTime)
 
                     CrashReport.setUserSceneTag(applicationContext, 261773)
-                    if(!MockServiceHelper.move(locationManager!!, FakeLoc.speed / (1000 / delayTime) / 0.85, FakeLoc.bearing)) {
-                        Log.e("MockServiceViewModel", "Failed to move")
-                    }
+                    submitTrajectory()
 
 //                    if (MockServiceHelper.broadcastLocation(locationManager!!)) {
 //                        Log.d("MockServiceViewModel", "Broadcast location")
@@ -83,90 +89,42 @@ class MockServiceViewModel : ViewModel() {
             val delayTime = activity.reportDuration.toLong()
             routeMockJob = GlobalScope.launch {
                 do {
-                    routeMockCoroutine.routeMockCoroutine()
+                    // 暂停/继续同步给Native路线播放
+                    routeMockCoroutine.routeMockCoroutine(
+                        onPause = {
+                            if (routeStage > 0) MockServiceHelper.pauseRoute(locationManager!!, true)
+                        },
+                        onResume = {
+                            if (routeStage > 0) MockServiceHelper.pauseRoute(locationManager!!, false)
+                        }
+                    )
                     delay(delayTime)
-                    // 如果是第0阶段，定位到第一个点
+                    // 如果是第0阶段，定位到第一个点并把整条路线交给Native路线引擎
                     if (routeStage == 0) {
+                        val route = selectedRoute!!.route
                         MockServiceHelper.setLocation(
                             locationManager!!,
-                            selectedRoute!!.route[0].first,
-                            selectedRoute!!.route[0].second
+                            route[0].first,
+                            route[0].second
                         )
-                        routeStage++
-                    }
-                    val route = selectedRoute!!.route
-
-                    // 处理所有已到达的阶段
-                    while (routeStage < route.size) {
-                        val target = route[routeStage]
-                        val location = MockServiceHelper.getLocation(locationManager!!)
-                        val currentLat = location!!.first
-                        val currentLon = location.second
-
-                        val inverse = Geodesic.WGS84.Inverse(
-                            currentLat,
-                            currentLon,
-                            target.first,
-                            target.second
-                        )
-                        // 判断距离是否小于1米（可根据需要调整阈值）
-                        if (inverse.s12 < 1.0) {
-                            // 精确设置位置到目标点并进入下一阶段
-                            MockServiceHelper.setLocation(
-                                locationManager!!,
-                                target.first,
-                                target.second
-                            )
-                            routeStage++
-                        } else if (inverse.s12 < FakeLoc.speed / (1000 / delayTime) / 0.85) {
-                            // 如果距离小于速度，直接移动到目标点
-                            MockServiceHelper.setLocation(
-                                locationManager!!,
-                                target.first,
-                                target.second
-                            )
+                        if (MockServiceHelper.startRoute(locationManager!!, route, FakeLoc.speed)) {
                             routeStage++
-
                         } else {
-                            break
+                            Log.e("MockServiceViewModel", "启动路线失败")
+                            routeMockCoroutine.pause()
+                            rocker.autoStatus = false
                         }
+                        continue
                     }
 
-                    // 检查是否已完成所有阶段
-                    if (routeStage >= route.size) {
+                    // 位置由系统进程按时间推算，这里只检查是否已走完
+                    if (!MockServiceHelper.isRouteStart(locationManager!!)) {
                         routeMockCoroutine.pause()
                         rocker.autoStatus = false
                         // 重设阶段
                         routeStage = 0
                         break // 退出循环
                     }
-
-                    // 处理当前目标点的移动
-                    val target = route[routeStage]
-                    val location = MockServiceHelper.getLocation(locationManager!!)
-                    val currentLat = location!!.first
-                    val currentLon = location.second
-
-                    val inverse = Geodesic.WGS84.Inverse(
-                        currentLat,
-                        currentLon,
-                        target.first,
-                        target.second
-                    )
-                    var azimuth = inverse.azi1
-                    if (azimuth < 0) {
-                        azimuth += 360
-                    }
-
-                    Log.d("MockServiceViewModel", "从 $currentLat, $currentLon 移动到 ${target.first}, ${target.second}, 方位角: $azimuth")
-                    if (!MockServiceHelper.move(
-                            locationManager!!,
-                            FakeLoc.speed / (1000 / delayTime) / 0.85,
-                            azimuth
-                        )
-                    ) {
-                        Log.e("MockServiceViewModel", "移动失败")
-                    }
                 } while (isActive)
             }
         }
@@ -174,6 +132,26 @@ class MockServiceViewModel : ViewModel() {
         return rocker
     }
 
+    /**
+     * 速度/方向变化或规划将用完时提交新的一段轨迹，其余tick不跨进程
+     */
+    private fun submitTrajectory() {
+        val locationManager = locationManager ?: return
+        val now = SystemClock.elapsedRealtimeNanos()
+        val speed = FakeLoc.speed
+        val bearing = FakeLoc.bearing
+        if (!trajectoryPlanner.needsReplan(now, speed, bearing)) {
+            return
+        }
+        // 从上一段规划的当前位置接着走，第一次从系统进程取当前位置
+        val start = trajectoryPlanner.positionAt(now) ?: MockServiceHelper.getLocation(locationManager) ?: return
+        val plan = trajectoryPlanner.plan(now, start.first, start.second, FakeLoc.altitude, speed, bearing)
+        if (MockServiceHelper.submitStates(locationManager, plan) <= 0) {
+            Log.e("MockServiceViewModel", "Failed to submit states")
+            trajectoryPlanner.reset()
+        }
+    }
+
     fun isServiceStart(): Boolean {
         return locationManager != null && MockServiceHelper.isServiceInit() && MockServiceHelper.isMockStart(
             locationManager!!
@@ -0,0 +1,80 @@
+// Counter-based noise: reproducibility, Gaussian moments, batch fill against single draws, bounded pink/drift.
+
+#include "noise.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace portal;
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "check failed: %s (%s:%d)\n", #cond, __FILE__, __LINE__); return 1; } } while (0)
+
+int main() {
+    constexpr size_t kDraws = 1000000;
+
+    // Same (seed, stream, counter) always gives the same value, another seed does not.
+    NoiseGenerator a(0x1234), b(0x1234), c(0x1235);
+    for (uint64_t counter = 0; counter < 1000; counter++) {
+        CHECK(a.gaussian(NOISE_STREAM_SENSOR, counter) == b.gaussian(NOISE_STREAM_SENSOR, counter));
+        CHECK(a.uniform(NOISE_STREAM_LOCATION, counter) == b.uniform(NOISE_STREAM_LOCATION, counter));
+    }
+    int same = 0;
+    for (uint64_t counter = 0; counter < 1000; counter++) {
+        same += a.gaussian(NOISE_STREAM_SENSOR, counter) == c.gaussian(NOISE_STREAM_SENSOR, counter);
+        same += a.gaussian(NOISE_STREAM_SENSOR, counter) == a.gaussian(NOISE_STREAM_GYRO_BIAS, counter);
+    }
+    CHECK(same < 5);
+    setNoiseSeed(42);
+    CHECK(sessionNoise().seed() == 42);
+    CHECK(sessionNoise().gaussian(NOISE_STREAM_SENSOR, 7) == NoiseGenerator(42).gaussian(NOISE_STREAM_SENSOR, 7));
+
+    // Both batch overloads match single draws element by element.
+    std::vector<float> filled(kDraws);
+    a.fillGaussian(NOISE_STREAM_SENSOR, 1000, filled.data(), filled.size());
+    std::vector<uint64_t> counters(4099);
+    for (size_t i = 0; i < counters.size(); i++) counters[i] = i * 977 + 3;
+    std::vector<float> scattered(counters.size());
+    a.fillGaussian(NOISE_STREAM_SENSOR, counters.data(), scattered.data(), scattered.size());
+    for (size_t i = 0; i < counters.size(); i++) {
+        CHECK(filled[i] == a.gaussian(NOISE_STREAM_SENSOR, 1000 + i));
+        CHECK(scattered[i] == a.gaussian(NOISE_STREAM_SENSOR, counters[i]));
+    }
+
+    // Rough Gaussian moments.
+    double sum = 0, sumSquares = 0;
+    for (float x: filled) {
+        CHECK(std::isfinite(x));
+        sum += x;
+        sumSquares += (double) x * x;
+    }
+    double mean = sum / kDraws;
+    double variance = sumSquares / kDraws - mean * mean;
+    printf("gaussian: mean %.4f, variance %.4f\n", mean, variance);
+    CHECK(fabs(mean) < 0.01);
+    CHECK(fabs(variance - 1.0) < 0.01);
+
+    double uniformSum = 0;
+    for (uint64_t i = 0; i < kDraws; i++) {
+        double u = a.uniform(NOISE_STREAM_LOCATION, i);
+        CHECK(u >= 0.0 && u < 1.0);
+        uniformSum += u;
+    }
+    printf("uniform: mean %.4f\n", uniformSum / kDraws);
+    CHECK(fabs(uniformSum / kDraws - 0.5) < 0.01);
+
+    // Pink noise and drift are sums and blends of unit Gaussians, so they stay within a few sigma.
+    float pinkMax = 0, driftMax = 0;
+    for (uint64_t i = 0; i < kDraws; i++) {
+        pinkMax = std::max(pinkMax, fabsf(a.pink(NOISE_STREAM_MAG_WANDER, i)));
+        driftMax = std::max(driftMax, fabsf(a.drift(NOISE_STREAM_GYRO_BIAS, (double) i * 0.01, 30.0)));
+    }
+    printf("pink: max |x| %.2f, drift: max |x| %.2f\n", pinkMax, driftMax);
+    CHECK(pinkMax < 6.0f);
+    CHECK(driftMax < 6.0f);
+    // Drift is continuous: 10 ms apart never jumps far.
+    for (int i = 0; i < 100000; i++) {
+        CHECK(fabsf(a.drift(NOISE_STREAM_GYRO_BIAS, i * 0.01 + 0.01, 30.0) - a.drift(NOISE_STREAM_GYRO_BIAS, i * 0.01, 30.0)) < 0.01f);
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Sensor recorder stress test: three sensors at a simulated 1 kHz, every batch written to two connections.
+
+#include "sensor_recorder.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+using namespace portal;
+using Clock = std::chrono::steady_clock;
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "check failed: %s (%s:%d)\n", #cond, __FILE__, __LINE__); return 1; } } while (0)
+
+static constexpr int32_t kTypeAccelerometer = 1;
+static constexpr int32_t kTypeGyroscope = 4;
+static constexpr uint64_t kMask = (1ULL << kTypeAccelerometer) | (1ULL << kTypeGyroscope);
+
+static long long fileSize(const char *name) {
+    struct stat st{};
+    std::string path = std::string(PORTAL_TRACE_DIR) + name;
+    return ::stat(path.c_str(), &st) == 0 ? (long long) st.st_size : -1;
+}
+
+int main() {
+    CHECK(!startSensorRecord("../escape.trace", kMask, 4096));
+    CHECK(!startSensorRecord("dir/escape.trace", kMask, 4096));
+    CHECK(!startSensorRecord("", kMask, 4096));
+
+    constexpr int kMillis = 3000;
+    CHECK(startSensorRecord("stress.trace", kMask, 8192));
+
+    // Accelerometer, its wake-up sibling of the same type, and a gyroscope; plus a magnetometer outside the mask.
+    sensors_event_t batch[4] = {};
+    batch[0].sensor = 1;
+    batch[0].type = kTypeAccelerometer;
+    batch[1].sensor = 11;
+    batch[1].type = kTypeAccelerometer;
+    batch[2].sensor = 4;
+    batch[2].type = kTypeGyroscope;
+    batch[3].sensor = 2;
+    batch[3].type = 2;
+
+    double hookNs = 0;
+    auto start = Clock::now();
+    for (int ms = 0; ms < kMillis; ms++) {
+        for (auto &event: batch) {
+            event.timestamp = (int64_t) (ms + 1) * 1000000;
+            event.data[0] = (float) ms;
+        }
+        auto begin = Clock::now();
+        recordSensorEvents(batch, std::size(batch));
+        recordSensorEvents(batch, std::size(batch)); // same batch on a second connection
+        hookNs += std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(ms + 1));
+    }
+    CHECK(sensorRecordStats().recording);
+    stopSensorRecord();
+    // The final counters outlive the session.
+    RecorderStats stats = sensorRecordStats();
+    CHECK(!stats.recording);
+    printf("1 kHz: recorded=%llu dropped=%llu contended=%llu, %.0f ns per hook call\n",
+           (unsigned long long) stats.recorded, (unsigned long long) stats.dropped,
+           (unsigned long long) stats.contended, hookNs / (kMillis * 2));
+    CHECK(stats.recorded == (uint64_t) kMillis * 3);
+    CHECK(stats.dropped == 0);
+    CHECK(fileSize("stress.trace") == (long long) (sizeof(TraceHeader) + stats.recorded * sizeof(TraceRecord)));
+    CHECK(fileSize("stress.trace") == (long long) stats.bytesWritten);
+
+    // Racing starts on the same name: exactly one wins, and the loser never truncates the winner's header.
+    for (int round = 0; round < 100; round++) {
+        std::atomic<int> started{0};
+        std::vector<std::thread> racers;
+        for (int i = 0; i < 4; i++) {
+            racers.emplace_back([&started] { started += startSensorRecord("race.trace", kMask, 4096) ? 1 : 0; });
+        }
+        for (auto &racer: racers) racer.join();
+        CHECK(started == 1);
+        CHECK(fileSize("race.trace") == (long long) sizeof(TraceHeader));
+        stopSensorRecord();
+    }
+
+    // A burst far larger than the smallest ring must drop, and account for every event it could not keep.
+    constexpr size_t kBurst = 16384;
+    CHECK(startSensorRecord("burst.trace", kMask, 1));
+    std::vector<sensors_event_t> burst(kBurst);
+    for (size_t i = 0; i < kBurst; i++) {
+        burst[i].sensor = 1;
+        burst[i].type = kTypeAccelerometer;
+        burst[i].timestamp = (int64_t) i + 1;
+    }
+    recordSensorEvents(burst.data(), burst.size());
+    stopSensorRecord();
+    stats = sensorRecordStats();
+    printf("burst: recorded=%llu dropped=%llu\n", (unsigned long long) stats.recorded, (unsigned long long) stats.dropped);
+    CHECK(stats.dropped > 0);
+    CHECK(stats.recorded + stats.dropped == kBurst);
+    CHECK(fileSize("burst.trace") == (long long) (sizeof(TraceHeader) + stats.recorded * sizeof(TraceRecord)));
+    return 0;
+}
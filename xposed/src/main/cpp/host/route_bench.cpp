@@ -0,0 +1,88 @@
+// Route engine benchmark on a 100k vertex polyline.
+
+#include "route_engine.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace portal;
+using Clock = std::chrono::steady_clock;
+
+static double elapsedNs(Clock::time_point begin, Clock::time_point end) {
+    return std::chrono::duration<double, std::nano>(end - begin).count();
+}
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "check failed: %s (%s:%d)\n", #cond, __FILE__, __LINE__); return 1; } } while (0)
+
+int main() {
+    constexpr size_t kVertices = 100000;
+    constexpr int kQueries = 1000000;
+
+    std::vector<RoutePoint> points;
+    points.reserve(kVertices);
+    for (size_t i = 0; i < kVertices; i++) {
+        points.push_back({30.0 + (double) i * 1e-5, 120.0 + 0.001 * sin((double) i * 0.001)});
+    }
+
+    RouteEngine engine;
+    auto begin = Clock::now();
+    CHECK(engine.load(points.data(), points.size()));
+    auto end = Clock::now();
+    engine.setSpeedProfile({.speed = 1.4, .variation = 0.3});
+    printf("load: %zu vertices, %.1f m, %.2f ms\n", engine.size(), engine.length(), elapsedNs(begin, end) / 1e6);
+
+    double checksum = 0;
+    begin = Clock::now();
+    for (int i = 0; i < kQueries; i++) {
+        checksum += engine.sample(i * 0.01).lat;
+    }
+    end = Clock::now();
+    printf("sequential sample: %.1f ns/query\n", elapsedNs(begin, end) / kQueries);
+
+    begin = Clock::now();
+    for (int i = 0; i < kQueries; i++) {
+        checksum += engine.sampleAtDistance(fmod(i * 7919.0, engine.length())).lat;
+    }
+    end = Clock::now();
+    printf("random sample: %.1f ns/query (checksum %.3f)\n", elapsedNs(begin, end) / kQueries, checksum);
+
+    RouteSample last = engine.sampleAtDistance(engine.length());
+    CHECK(last.finished);
+    CHECK(fabs(last.lat - points.back().lat) < 1e-7 && fabs(last.lon - points.back().lon) < 1e-7);
+
+    RouteEngine smoothed;
+    CHECK(smoothed.load(points.data(), 1000, 8));
+    printf("smoothing: 1000 -> %zu vertices\n", smoothed.size());
+    // A bogus subdivision count from the Bundle is clamped instead of exhausting memory.
+    CHECK(smoothed.load(points.data(), 1000, INT32_MAX));
+    CHECK(smoothed.size() <= 1000 * RouteEngine::kMaxSmoothing);
+
+    // East then north is a left turn, curvature must be negative.
+    RoutePoint corner[] = {{0, 0}, {0, 0.001}, {0.001, 0.001}};
+    RouteEngine turn;
+    CHECK(turn.load(corner, 3));
+    CHECK(turn.sampleAtDistance(turn.length() / 2).curvature < 0);
+
+    // Playback stops by itself at the end and resumes from where it was paused.
+    auto shared = std::make_shared<RouteEngine>();
+    CHECK(shared->load(corner, 3));
+    shared->setSpeedProfile({.speed = 10.0});
+    startRoutePlayback(shared, 0);
+    pauseRoutePlayback(true, 5000000000LL);
+    RouteSample paused;
+    CHECK(sampleRoutePlayback(60000000000LL, paused) && paused.speed == 0 && !paused.finished);
+    pauseRoutePlayback(false, 60000000000LL);
+    RouteSample resumed;
+    CHECK(sampleRoutePlayback(60000000000LL, resumed) && fabs(resumed.distance - paused.distance) < 1e-6);
+    // A batch snapshot past the end holds still there without ending the playback for the location path.
+    RouteSample held;
+    CHECK(routePlayback().sample(600000000000LL, held) && held.finished && held.speed == 0);
+    CHECK(isRoutePlaying());
+    RouteSample done;
+    CHECK(sampleRoutePlayback(600000000000LL, done) && done.finished);
+    CHECK(!isRoutePlaying());
+    CHECK(!sampleRoutePlayback(600000000000LL, done));
+    return 0;
+}
@@ -0,0 +1,19 @@
+// Host stand-in for the NDK logging header, prints to stderr.
+
+#ifndef PORTAL_HOST_ANDROID_LOG_H
+#define PORTAL_HOST_ANDROID_LOG_H
+
+#include <cstdio>
+
+#define ANDROID_LOG_VERBOSE 2
+#define ANDROID_LOG_DEBUG 3
+#define ANDROID_LOG_INFO 4
+#define ANDROID_LOG_ERROR 6
+
+#ifndef __FILE_NAME__
+#define __FILE_NAME__ __FILE__
+#endif
+
+#define __android_log_print(priority, tag, ...) (fprintf(stderr, __VA_ARGS__), fputc('\n', stderr))
+
+#endif //PORTAL_HOST_ANDROID_LOG_H
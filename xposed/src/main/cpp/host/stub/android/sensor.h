@@ -0,0 +1,8 @@
+// Host stand-in for the NDK sensor header, sensor_hook.h only needs the fixed width types.
+
+#ifndef PORTAL_HOST_ANDROID_SENSOR_H
+#define PORTAL_HOST_ANDROID_SENSOR_H
+
+#include <stdint.h>
+
+#endif //PORTAL_HOST_ANDROID_SENSOR_H
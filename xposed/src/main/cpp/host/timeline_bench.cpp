@@ -0,0 +1,170 @@
+// State timeline benchmark: interpolation error of planned walks, the sample cap, and native calls per second.
+
+#include "state_timeline.h"
+#include "route_engine.h"
+#include "sensor_hook.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace portal;
+using Clock = std::chrono::steady_clock;
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "check failed: %s (%s:%d)\n", #cond, __FILE__, __LINE__); return 1; } } while (0)
+
+// Stand-in for the sensor hook's config entry point, which needs the device build; counts the calls.
+static uint64_t gUpdateConfigCalls = 0;
+
+void updateSensorConfig(bool enable, double speed, double bearing) {
+    gUpdateConfigCalls++;
+}
+
+static constexpr double kMetresPerDegree = 6371000.0 * M_PI / 180.0;
+static constexpr double kOriginLat = 30.0;
+static constexpr double kOriginLon = 120.0;
+static constexpr double kRadius = 50.0; // metres
+static constexpr double kSpeed = 1.4;   // m/s
+
+// Walking a circle around the origin; exact position at `seconds`.
+static StateSample walkAt(int64_t baseNs, double seconds) {
+    double theta = kSpeed * seconds / kRadius;
+    double north = kRadius * cos(theta);
+    double east = kRadius * sin(theta);
+    double bearing = fmod(90.0 + theta * 180.0 / M_PI, 360.0);
+    return {
+            .timestampNs = baseNs + (int64_t) (seconds * 1e9),
+            .lat = kOriginLat + north / kMetresPerDegree,
+            .lon = kOriginLon + east / (kMetresPerDegree * cos(kOriginLat * M_PI / 180.0)),
+            .altitude = 10.0,
+            .bearing = (float) bearing,
+            .speed = (float) kSpeed,
+            .mode = MOTION_WALK,
+            .reserved = 0,
+    };
+}
+
+static double distanceMetres(const StateSample &a, const StateSample &b) {
+    double north = (a.lat - b.lat) * kMetresPerDegree;
+    double east = (a.lon - b.lon) * kMetresPerDegree * cos(kOriginLat * M_PI / 180.0);
+    return hypot(north, east);
+}
+
+static std::vector<StateSample> plan(int64_t baseNs, double seconds, double hz) {
+    std::vector<StateSample> samples;
+    for (int i = 0; i <= (int) (seconds * hz); i++) {
+        samples.push_back(walkAt(baseNs, i / hz));
+    }
+    return samples;
+}
+
+int main() {
+    constexpr double kPlanSeconds = 60.0;
+    constexpr double kSampleHz = 200.0;
+    int64_t base = bootTimeNs();
+
+    // Interpolation error against the exact walk, queried at the sensor rate.
+    for (double hz: {10.0, 2.0}) {
+        StateTimeline timeline(plan(base, kPlanSeconds, hz));
+        double maxError = 0;
+        double sumSquares = 0;
+        int queries = 0;
+        for (int i = 0; i < (int) (kPlanSeconds * kSampleHz); i++) {
+            double seconds = i / kSampleHz;
+            double error = distanceMetres(timeline.sample(base + (int64_t) (seconds * 1e9)), walkAt(base, seconds));
+            maxError = std::max(maxError, error);
+            sumSquares += error * error;
+            queries++;
+        }
+        printf("%.0f Hz plan: max error %.2f mm, rms %.2f mm\n", hz, maxError * 1e3, sqrt(sumSquares / queries) * 1e3);
+        CHECK(maxError < 0.01);
+    }
+
+    // History behind the horizon goes first, then the tail of an oversized batch; near-now samples stay.
+    clearStates();
+    std::vector<StateSample> first;
+    for (int i = 0; i < 50; i++) first.push_back(walkAt(base, -10.0 + i * 0.1));
+    for (int i = 0; i < 50; i++) first.push_back(walkAt(base, i * 0.1));
+    CHECK(submitStates(first.data(), first.size(), true) == first.size());
+    std::vector<StateSample> future;
+    for (int i = 0; i < 10000; i++) future.push_back(walkAt(base, 10.0 + i * 0.1));
+    size_t accepted = submitStates(future.data(), future.size(), false);
+    auto timeline = stateTimeline();
+    printf("cap: accepted %zu of %zu, timeline holds %zu\n", accepted, future.size(), timeline->samples().size());
+    CHECK(accepted == 8192 - 51);
+    CHECK(timeline->samples().size() == 8192);
+    CHECK(timeline->samples()[0].timestampNs == first[49].timestampNs);
+    CHECK(timeline->samples()[1].timestampNs == first[50].timestampNs);
+    CHECK(timeline->samples().back().timestampNs == future[accepted - 1].timestampNs);
+
+    // Five minutes of rocker input at the default 100 ms report interval: a turn every 30 s, a speed change
+    // at 2:30. The old step loop sends one `move` per tick, and every `move` ends in updateSensorConfig.
+    // The planner mirrors TrajectoryPlanner: a 10 s plan at 10 Hz, re-planned on input changes or 2 s before
+    // it runs out. Both loops count their transitions into native code.
+    clearStates();
+    constexpr int64_t kTickNs = 100000000;
+    constexpr int64_t kRunNs = 300000000000LL;
+    constexpr int64_t kHorizonNs = 10000000000LL;
+    constexpr int64_t kRefreshNs = 2000000000LL;
+    auto input = [](int64_t elapsedNs, double &speed, double &bearing) {
+        speed = elapsedNs < kRunNs / 2 ? 1.4 : 3.0;
+        bearing = (double) (elapsedNs / 30000000000LL) * 45.0;
+    };
+
+    uint64_t stepCalls = 0;
+    for (int64_t elapsed = 0; elapsed < kRunNs; elapsed += kTickNs) {
+        double speed, bearing;
+        input(elapsed, speed, bearing);
+        updateSensorConfig(true, speed, bearing);
+        stepCalls++;
+    }
+
+    uint64_t submitCalls = 0;
+    uint64_t submittedSamples = 0;
+    double submitNs = 0;
+    double planSpeed = -1, planBearing = 0;
+    int64_t planEnd = 0;
+    for (int64_t elapsed = 0; elapsed < kRunNs; elapsed += kTickNs) {
+        double speed, bearing;
+        input(elapsed, speed, bearing);
+        if (elapsed <= planEnd - kRefreshNs && speed == planSpeed && bearing == planBearing) {
+            continue;
+        }
+        std::vector<StateSample> window;
+        for (int64_t t = 0; t <= kHorizonNs; t += kTickNs) {
+            window.push_back(walkAt(base, (double) (elapsed + t) / 1e9));
+            window.back().speed = (float) speed;
+            window.back().bearing = (float) bearing;
+        }
+        auto begin = Clock::now();
+        size_t kept = submitStates(window.data(), window.size(), true);
+        submitNs += std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+        CHECK(kept == window.size());
+        submitCalls++;
+        submittedSamples += kept;
+        planSpeed = speed;
+        planBearing = bearing;
+        planEnd = elapsed + kHorizonNs;
+    }
+    printf("native calls over %.0f s: step loop %llu updateSensorConfig (%.2f/s), planner %llu submitStates (%.2f/s, %llu samples, %.1f us each)\n",
+           kRunNs / 1e9, (unsigned long long) stepCalls, stepCalls / (kRunNs / 1e9),
+           (unsigned long long) submitCalls, submitCalls / (kRunNs / 1e9), (unsigned long long) submittedSamples,
+           submitNs / submitCalls / 1e3);
+    CHECK(stepCalls == gUpdateConfigCalls);
+    CHECK(submitCalls * 10 < stepCalls);
+
+    // Sampling cost of the timeline the planner left behind, as paid by the sensor hook per event.
+    timeline = stateTimeline();
+    constexpr int kQueries = 1000000;
+    double checksum = 0;
+    auto begin = Clock::now();
+    for (int i = 0; i < kQueries; i++) {
+        checksum += timeline->sample(base + (int64_t) i * 300000 % kRunNs).lat;
+    }
+    double sampleNs = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+    printf("sample: %.1f ns over %zu samples (checksum %.3f)\n", sampleNs / kQueries, timeline->samples().size(), checksum);
+    clearStates();
+    CHECK(!hasStates());
+    return 0;
+}
@@ -4,6 +4,10 @@
 #include <sys/mman.h>
 #include <unistd.h>
 #include "sensor_hook.h"
+#include "route_engine.h"
+#include "sensor_recorder.h"
+#include "noise.h"
+#include "state_timeline.h"
 
 bool enableSensorHook = false;
 
@@ -34,4 +38,162 @@ extern "C"
 JNIEXPORT void JNICALL
 Java_moe_fuqiuluo_xposed_FakeLocation_nativeUpdateConfig(JNIEnv *env, jobject thiz, jboolean enable, jdouble speed, jdouble bearing) {
     updateSensorConfig(enable, speed, bearing);
-}
\ No newline at end of file
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeLoadRoute(JNIEnv *env, jobject thiz, jdoubleArray points, jdouble speed, jdouble speedVariation, jint smoothing) {
+    if (points == nullptr) {
+        return JNI_FALSE;
+    }
+    jsize length = env->GetArrayLength(points);
+    jdouble* coords = env->GetDoubleArrayElements(points, nullptr);
+    if (coords == nullptr) {
+        return JNI_FALSE;
+    }
+    // points is laid out as [lat0, lon0, lat1, lon1, ...]
+    auto engine = std::make_shared<portal::RouteEngine>();
+    bool loaded = engine->load(reinterpret_cast<const portal::RoutePoint*>(coords), length / 2, smoothing);
+    env->ReleaseDoubleArrayElements(points, coords, JNI_ABORT);
+    if (!loaded) {
+        return JNI_FALSE;
+    }
+    engine->setSpeedProfile({ .speed = speed, .variation = speedVariation });
+    portal::startRoutePlayback(std::move(engine), portal::bootTimeNs());
+    return JNI_TRUE;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeStopRoute(JNIEnv *env, jobject thiz) {
+    portal::stopRoutePlayback();
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativePauseRoute(JNIEnv *env, jobject thiz, jboolean paused) {
+    portal::pauseRoutePlayback(paused, portal::bootTimeNs());
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeSampleRoute(JNIEnv *env, jobject thiz, jdoubleArray out) {
+    portal::RouteSample sample;
+    if (out == nullptr || env->GetArrayLength(out) < 7 || !portal::sampleRoutePlayback(portal::bootTimeNs(), sample)) {
+        return JNI_FALSE;
+    }
+    // [lat, lon, bearing, speed, curvature, distance, finished]
+    jdouble values[7] = {
+            sample.lat, sample.lon, sample.bearing, sample.speed,
+            sample.curvature, sample.distance, sample.finished ? 1.0 : 0.0
+    };
+    env->SetDoubleArrayRegion(out, 0, 7, values);
+    return JNI_TRUE;
+}
+
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeStartSensorRecord(JNIEnv *env, jobject thiz, jstring name, jlong typeMask, jint capacity) {
+    if (name == nullptr) {
+        return JNI_FALSE;
+    }
+    const char* fileName = env->GetStringUTFChars(name, nullptr);
+    if (fileName == nullptr) {
+        return JNI_FALSE;
+    }
+    bool started = portal::startSensorRecord(fileName, (uint64_t) typeMask, capacity > 0 ? (size_t) capacity : 0);
+    env->ReleaseStringUTFChars(name, fileName);
+    return started ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeStopSensorRecord(JNIEnv *env, jobject thiz) {
+    portal::stopSensorRecord();
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeSensorRecordStats(JNIEnv *env, jobject thiz, jlongArray out) {
+    if (out == nullptr || env->GetArrayLength(out) < 4) {
+        return JNI_FALSE;
+    }
+    portal::RecorderStats stats = portal::sensorRecordStats();
+    // [recorded, dropped, contended, bytesWritten], the last session's counters once stopped
+    jlong values[4] = {
+            (jlong) stats.recorded, (jlong) stats.dropped,
+            (jlong) stats.contended, (jlong) stats.bytesWritten
+    };
+    env->SetLongArrayRegion(out, 0, 4, values);
+    return stats.recording ? JNI_TRUE : JNI_FALSE;
+}
+
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeSetNoiseSeed(JNIEnv *env, jobject thiz, jlong seed) {
+    portal::setNoiseSeed((uint64_t) seed);
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeGetNoiseSeed(JNIEnv *env, jobject thiz) {
+    return (jlong) portal::sessionNoise().seed();
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeGaussianNoise(JNIEnv *env, jobject thiz, jlong stream, jlong counter, jfloatArray out) {
+    if (out == nullptr) {
+        return JNI_FALSE;
+    }
+    jsize length = env->GetArrayLength(out);
+    if (length <= 0 || length > 256) {
+        return JNI_FALSE;
+    }
+    jfloat values[256];
+    portal::sessionNoise().fillGaussian(portal::NOISE_STREAM_LOCATION + (uint64_t) stream, (uint64_t) counter, values, length);
+    env->SetFloatArrayRegion(out, 0, length, values);
+    return JNI_TRUE;
+}
+
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeSubmitStates(JNIEnv *env, jobject thiz, jbyteArray states, jboolean replace) {
+    if (states == nullptr) {
+        return 0;
+    }
+    jsize count = env->GetArrayLength(states) / (jsize) sizeof(portal::StateSample);
+    if (count <= 0) {
+        return 0;
+    }
+    // Copy out first, the merge takes locks and allocates, which must not happen inside a critical region
+    std::vector<portal::StateSample> samples(count);
+    env->GetByteArrayRegion(states, 0, count * (jsize) sizeof(portal::StateSample), reinterpret_cast<jbyte*>(samples.data()));
+    return (jint) portal::submitStates(samples.data(), samples.size(), replace);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeClearStates(JNIEnv *env, jobject thiz) {
+    portal::clearStates();
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_moe_fuqiuluo_xposed_FakeLocation_nativeSampleState(JNIEnv *env, jobject thiz, jdoubleArray out) {
+    auto timeline = portal::stateTimeline();
+    if (out == nullptr || env->GetArrayLength(out) < 6 || timeline == nullptr) {
+        return JNI_FALSE;
+    }
+    portal::StateSample state = timeline->sample(portal::bootTimeNs());
+    // [lat, lon, altitude, bearing, speed, mode]
+    jdouble values[6] = {
+            state.lat, state.lon, state.altitude,
+            state.bearing, state.speed, (jdouble) state.mode
+    };
+    env->SetDoubleArrayRegion(out, 0, 6, values);
+    return JNI_TRUE;
+}
@@ -0,0 +1,71 @@
+#include "noise.h"
+#include "route_engine.h"
+#include <algorithm>
+#include <atomic>
+
+namespace portal {
+
+    static constexpr size_t kFillChunk = 64;
+
+    static std::atomic<uint64_t> gNoiseSeed{0};
+
+    float NoiseGenerator::pink(uint64_t stream, uint64_t index, int octaves) const {
+        float sum = 0.0f;
+        for (int k = 0; k < octaves; k++) {
+            sum += gaussianFromBits(squares64(index >> k, key(stream + ((uint64_t) k << 32))));
+        }
+        return sum / sqrtf((float) octaves);
+    }
+
+    float NoiseGenerator::drift(uint64_t stream, double seconds, double period) const {
+        double position = seconds / period;
+        double knot = floor(position);
+        auto t = (float) (position - knot);
+        auto index = (uint64_t) (int64_t) knot;
+        uint64_t k = key(stream);
+        float a = gaussianFromBits(squares64(index, k));
+        float b = gaussianFromBits(squares64(index + 1, k));
+        float s = t * t * (3.0f - 2.0f * t);
+        return a + (b - a) * s;
+    }
+
+    // One Gaussian per counter, the draws are staged in chunks of kFillChunk. This stays scalar on purpose:
+    // Squares needs 64x64 multiplies that NEON lacks, and a hook batch is at most a few hundred draws, which
+    // did not justify a second, Philox-based generator next to the one every other noise source uses.
+    template<typename CounterAt>
+    static void fillChunked(uint64_t key, CounterAt counterAt, float *out, size_t count) {
+        uint64_t bits[kFillChunk];
+        for (size_t base = 0; base < count; base += kFillChunk) {
+            size_t n = std::min(kFillChunk, count - base);
+            for (size_t i = 0; i < n; i++) {
+                bits[i] = squares64(counterAt(base + i), key);
+            }
+            for (size_t i = 0; i < n; i++) {
+                out[base + i] = gaussianFromBits(bits[i]);
+            }
+        }
+    }
+
+    void NoiseGenerator::fillGaussian(uint64_t stream, const uint64_t *counters, float *out, size_t count) const {
+        fillChunked(key(stream), [counters](size_t i) { return counters[i]; }, out, count);
+    }
+
+    void NoiseGenerator::fillGaussian(uint64_t stream, uint64_t firstCounter, float *out, size_t count) const {
+        fillChunked(key(stream), [firstCounter](size_t i) { return firstCounter + i; }, out, count);
+    }
+
+    void setNoiseSeed(uint64_t seed) {
+        gNoiseSeed.store(seed, std::memory_order_relaxed);
+    }
+
+    NoiseGenerator sessionNoise() {
+        uint64_t seed = gNoiseSeed.load(std::memory_order_relaxed);
+        if (seed == 0) {
+            // First use without an explicit seed, derive one from the boot clock.
+            uint64_t fresh = splitmix64((uint64_t) bootTimeNs()) | 1;
+            gNoiseSeed.compare_exchange_strong(seed, fresh, std::memory_order_relaxed);
+            seed = gNoiseSeed.load(std::memory_order_relaxed);
+        }
+        return NoiseGenerator(seed);
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef PORTAL_NOISE_H
+#define PORTAL_NOISE_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace portal {
+
+    // Independent noise streams, the low bits are free for an axis index.
+    enum NoiseStream : uint64_t {
+        NOISE_STREAM_SENSOR = 0x100,
+        NOISE_STREAM_GYRO_BIAS = 0x200,
+        NOISE_STREAM_MAG_WANDER = 0x300,
+        NOISE_STREAM_LOCATION = 0x400,
+    };
+
+    // Widynski's "Squares" counter-based generator: the output is a pure function of (counter, key),
+    // so any sample can be regenerated from the session seed and its index.
+    inline uint64_t squares64(uint64_t counter, uint64_t key) {
+        uint64_t t, x, y, z;
+        y = x = counter * key;
+        z = y + key;
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        x = x * x + z; x = (x >> 32) | (x << 32);
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        t = x = x * x + z; x = (x >> 32) | (x << 32);
+        return t ^ ((x * x + y) >> 32);
+    }
+
+    inline uint64_t splitmix64(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // Box-Muller on two 24-bit uniforms from one draw: the top 24 bits and the low 24 bits.
+    inline float gaussianFromBits(uint64_t bits) {
+        float u1 = ((float) (uint32_t) (bits >> 40) + 0.5f) * 0x1p-24f;
+        float u2 = (float) (uint32_t) (bits & 0xffffff) * 0x1p-24f;
+        return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float) M_PI * u2);
+    }
+
+    class NoiseGenerator {
+    public:
+        explicit NoiseGenerator(uint64_t seed) : seed_(seed) {}
+
+        uint64_t seed() const {
+            return seed_;
+        }
+
+        uint64_t key(uint64_t stream) const {
+            return splitmix64(seed_ ^ splitmix64(stream)) | 1;
+        }
+
+        // Uniform in [0, 1).
+        double uniform(uint64_t stream, uint64_t counter) const {
+            return (double) (squares64(counter, key(stream)) >> 11) * 0x1p-53;
+        }
+
+        float gaussian(uint64_t stream, uint64_t counter) const {
+            return gaussianFromBits(squares64(counter, key(stream)));
+        }
+
+        // Voss-McCartney 1/f noise without state: octave k holds its value for 2^k indices.
+        float pink(uint64_t stream, uint64_t index, int octaves = 12) const;
+
+        // Slowly wandering offset, smoothly interpolated between Gaussian knots `period` seconds apart.
+        float drift(uint64_t stream, double seconds, double period) const;
+
+        void fillGaussian(uint64_t stream, const uint64_t *counters, float *out, size_t count) const;
+
+        void fillGaussian(uint64_t stream, uint64_t firstCounter, float *out, size_t count) const;
+
+    private:
+        uint64_t seed_;
+    };
+
+    // 0 picks a fresh seed from the boot clock on next use.
+    void setNoiseSeed(uint64_t seed);
+
+    // Generator bound to the current session seed.
+    NoiseGenerator sessionNoise();
+}
+
+#endif //PORTAL_NOISE_H
@@ -0,0 +1,269 @@
+#include "route_engine.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <ctime>
+
+namespace portal {
+
+    static constexpr double kEarthRadius = 6371000.0;
+    static constexpr double kDegToRad = M_PI / 180.0;
+    static constexpr double kRadToDeg = 180.0 / M_PI;
+    static constexpr double kMinSegment = 1e-3; // metres, shorter segments are merged
+
+    static double haversine(const RoutePoint &a, const RoutePoint &b) {
+        double phi1 = a.lat * kDegToRad;
+        double phi2 = b.lat * kDegToRad;
+        double dPhi = phi2 - phi1;
+        double dLambda = (b.lon - a.lon) * kDegToRad;
+        double s1 = sin(dPhi / 2);
+        double s2 = sin(dLambda / 2);
+        double h = s1 * s1 + cos(phi1) * cos(phi2) * s2 * s2;
+        return 2 * kEarthRadius * atan2(sqrt(h), sqrt(1 - h));
+    }
+
+    static double initialBearing(const RoutePoint &a, const RoutePoint &b) {
+        double phi1 = a.lat * kDegToRad;
+        double phi2 = b.lat * kDegToRad;
+        double dLambda = (b.lon - a.lon) * kDegToRad;
+        double y = sin(dLambda) * cos(phi2);
+        double x = cos(phi1) * sin(phi2) - sin(phi1) * cos(phi2) * cos(dLambda);
+        return atan2(y, x);
+    }
+
+    static RoutePoint destination(const RoutePoint &from, double bearing, double distance) {
+        double delta = distance / kEarthRadius;
+        double phi1 = from.lat * kDegToRad;
+        double lambda1 = from.lon * kDegToRad;
+        double sinPhi2 = sin(phi1) * cos(delta) + cos(phi1) * sin(delta) * cos(bearing);
+        double phi2 = asin(sinPhi2);
+        double lambda2 = lambda1 + atan2(sin(bearing) * sin(delta) * cos(phi1), cos(delta) - sin(phi1) * sinPhi2);
+        return {phi2 * kRadToDeg, remainder(lambda2 * kRadToDeg, 360.0)};
+    }
+
+    static double wrapAngle(double rad) {
+        return remainder(rad, 2 * M_PI);
+    }
+
+    static void catmullRom(const RoutePoint *points, size_t count, int subdivisions, std::vector<RoutePoint> &out) {
+        out.reserve(count * subdivisions);
+        for (size_t i = 0; i + 1 < count; i++) {
+            const RoutePoint &p0 = points[i == 0 ? 0 : i - 1];
+            const RoutePoint &p1 = points[i];
+            const RoutePoint &p2 = points[i + 1];
+            const RoutePoint &p3 = points[i + 2 < count ? i + 2 : count - 1];
+            for (int k = 0; k < subdivisions; k++) {
+                double t = (double) k / subdivisions;
+                double t2 = t * t;
+                double t3 = t2 * t;
+                auto blend = [&](double a, double b, double c, double d) {
+                    return 0.5 * ((2 * b) + (-a + c) * t + (2 * a - 5 * b + 4 * c - d) * t2 + (-a + 3 * b - 3 * c + d) * t3);
+                };
+                out.push_back({blend(p0.lat, p1.lat, p2.lat, p3.lat), blend(p0.lon, p1.lon, p2.lon, p3.lon)});
+            }
+        }
+        out.push_back(points[count - 1]);
+    }
+
+    bool RouteEngine::load(const RoutePoint *points, size_t count, int smoothing) {
+        points_.clear();
+        cumulative_.clear();
+        bearing_.clear();
+        curvature_.clear();
+        cursor_.store(0, std::memory_order_relaxed);
+        if (points == nullptr || count < 2) {
+            return false;
+        }
+
+        smoothing = std::clamp(smoothing, 0, kMaxSmoothing);
+        std::vector<RoutePoint> smoothed;
+        if (smoothing > 1 && count > 2) {
+            catmullRom(points, count, smoothing, smoothed);
+            points = smoothed.data();
+            count = smoothed.size();
+        }
+
+        points_.reserve(count);
+        cumulative_.reserve(count);
+        points_.push_back(points[0]);
+        cumulative_.push_back(0.0);
+        for (size_t i = 1; i < count; i++) {
+            double d = haversine(points_.back(), points[i]);
+            if (d < kMinSegment) {
+                continue;
+            }
+            bearing_.push_back(initialBearing(points_.back(), points[i]));
+            points_.push_back(points[i]);
+            cumulative_.push_back(cumulative_.back() + d);
+        }
+        if (points_.size() < 2) {
+            points_.clear();
+            cumulative_.clear();
+            bearing_.clear();
+            return false;
+        }
+
+        // Discrete curvature at each vertex: heading change over the mean length of the adjacent segments.
+        size_t n = points_.size();
+        curvature_.assign(n, 0.0);
+        for (size_t i = 1; i + 1 < n; i++) {
+            double turn = wrapAngle(bearing_[i] - bearing_[i - 1]);
+            double span = 0.5 * (cumulative_[i + 1] - cumulative_[i - 1]);
+            curvature_[i] = turn / span;
+        }
+        return true;
+    }
+
+    void RouteEngine::setSpeedProfile(const SpeedProfile &profile) {
+        profile_ = profile;
+        if (profile_.speed < 0) {
+            profile_.speed = 0;
+        }
+        // Keep the speed strictly positive so that distance is monotonic in time.
+        profile_.variation = std::clamp(fabs(profile_.variation), 0.0, profile_.speed * 0.9);
+        if (profile_.period <= 0) {
+            profile_.period = 20.0;
+        }
+    }
+
+    double RouteEngine::speedAt(double elapsed) const {
+        double omega = 2 * M_PI / profile_.period;
+        return profile_.speed + profile_.variation * cos(omega * elapsed);
+    }
+
+    double RouteEngine::distanceAt(double elapsed) const {
+        if (elapsed <= 0) {
+            return 0.0;
+        }
+        double omega = 2 * M_PI / profile_.period;
+        double s = profile_.speed * elapsed + profile_.variation / omega * sin(omega * elapsed);
+        return std::min(s, length());
+    }
+
+    size_t RouteEngine::locate(double distance) const {
+        size_t last = cumulative_.size() - 2;
+        size_t cursor = cursor_.load(std::memory_order_relaxed);
+        if (cursor <= last) {
+            if (cumulative_[cursor] <= distance && distance < cumulative_[cursor + 1]) {
+                return cursor;
+            }
+            if (cursor + 1 <= last && cumulative_[cursor + 1] <= distance && distance < cumulative_[cursor + 2]) {
+                cursor_.store(cursor + 1, std::memory_order_relaxed);
+                return cursor + 1;
+            }
+        }
+        auto it = std::upper_bound(cumulative_.begin(), cumulative_.end(), distance);
+        size_t index = it == cumulative_.begin() ? 0 : (size_t) (it - cumulative_.begin()) - 1;
+        index = std::min(index, last);
+        cursor_.store(index, std::memory_order_relaxed);
+        return index;
+    }
+
+    RouteSample RouteEngine::sampleAtDistance(double distance) const {
+        RouteSample sample;
+        if (empty()) {
+            return sample;
+        }
+        distance = std::clamp(distance, 0.0, length());
+        size_t i = locate(distance);
+        double offset = distance - cumulative_[i];
+        double segment = cumulative_[i + 1] - cumulative_[i];
+        double t = offset / segment;
+
+        RoutePoint p = destination(points_[i], bearing_[i], offset);
+        sample.lat = p.lat;
+        sample.lon = p.lon;
+        double bearing = bearing_[i] * kRadToDeg;
+        sample.bearing = bearing < 0 ? bearing + 360.0 : bearing;
+        sample.curvature = curvature_[i] + (curvature_[i + 1] - curvature_[i]) * t;
+        sample.distance = distance;
+        sample.finished = distance >= length();
+        return sample;
+    }
+
+    RouteSample RouteEngine::sample(double elapsed) const {
+        RouteSample sample = sampleAtDistance(distanceAt(elapsed));
+        sample.speed = sample.finished ? 0.0 : speedAt(elapsed);
+        return sample;
+    }
+
+    static std::mutex gPlaybackLock;
+    static RoutePlayback gPlayback;
+    static std::atomic<bool> gPlaying{false};
+
+    bool RoutePlayback::sample(int64_t timestampNs, RouteSample &out) const {
+        if (engine == nullptr) {
+            return false;
+        }
+        int64_t at = pausedNs != 0 ? pausedNs : timestampNs;
+        out = engine->sample((double) (at - startNs) / 1e9);
+        if (pausedNs != 0) {
+            out.speed = 0.0;
+        }
+        return true;
+    }
+
+    void startRoutePlayback(std::shared_ptr<RouteEngine> engine, int64_t startNs) {
+        std::lock_guard<std::mutex> lock(gPlaybackLock);
+        bool valid = engine != nullptr && !engine->empty();
+        gPlayback = valid ? RoutePlayback{std::move(engine), startNs, 0} : RoutePlayback{};
+        gPlaying.store(valid, std::memory_order_release);
+    }
+
+    void stopRoutePlayback() {
+        std::lock_guard<std::mutex> lock(gPlaybackLock);
+        gPlaying.store(false, std::memory_order_release);
+        gPlayback = {};
+    }
+
+    void finishRoutePlayback(const RouteEngine *engine) {
+        std::lock_guard<std::mutex> lock(gPlaybackLock);
+        if (engine != nullptr && gPlayback.engine.get() == engine) {
+            gPlaying.store(false, std::memory_order_release);
+            gPlayback = {};
+        }
+    }
+
+    void pauseRoutePlayback(bool paused, int64_t nowNs) {
+        std::lock_guard<std::mutex> lock(gPlaybackLock);
+        if (gPlayback.engine == nullptr) {
+            return;
+        }
+        if (paused && gPlayback.pausedNs == 0) {
+            gPlayback.pausedNs = nowNs;
+        } else if (!paused && gPlayback.pausedNs != 0) {
+            // Shift the start so that playback resumes where it stopped.
+            gPlayback.startNs += nowNs - gPlayback.pausedNs;
+            gPlayback.pausedNs = 0;
+        }
+    }
+
+    bool isRoutePlaying() {
+        return gPlaying.load(std::memory_order_acquire);
+    }
+
+    RoutePlayback routePlayback() {
+        if (!isRoutePlaying()) {
+            return {};
+        }
+        std::lock_guard<std::mutex> lock(gPlaybackLock);
+        return gPlayback;
+    }
+
+    bool sampleRoutePlayback(int64_t timestampNs, RouteSample &out) {
+        RoutePlayback playback = routePlayback();
+        if (!playback.sample(timestampNs, out)) {
+            return false;
+        }
+        if (out.finished) {
+            finishRoutePlayback(playback.engine.get());
+        }
+        return true;
+    }
+
+    int64_t bootTimeNs() {
+        timespec ts{};
+        clock_gettime(CLOCK_BOOTTIME, &ts);
+        return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef PORTAL_ROUTE_ENGINE_H
+#define PORTAL_ROUTE_ENGINE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace portal {
+
+    struct RoutePoint {
+        double lat;
+        double lon;
+    };
+
+    struct RouteSample {
+        double lat = 0.0;
+        double lon = 0.0;
+        double bearing = 0.0;   // degrees, [0, 360)
+        double curvature = 0.0; // rad/m, positive when turning right
+        double speed = 0.0;     // m/s
+        double distance = 0.0;  // metres travelled along the route
+        bool finished = false;
+    };
+
+    // Base speed plus an optional sinusoidal variation, so that the travelled
+    // distance stays a closed form of the elapsed time.
+    struct SpeedProfile {
+        double speed = 1.4;
+        double variation = 0.0;
+        double period = 20.0;
+    };
+
+    class RouteEngine {
+    public:
+        static constexpr int kMaxSmoothing = 16;
+
+        // `smoothing` is the number of Catmull-Rom subdivisions per segment, clamped to [0, kMaxSmoothing];
+        // 0 keeps the polyline as is.
+        bool load(const RoutePoint *points, size_t count, int smoothing = 0);
+
+        void setSpeedProfile(const SpeedProfile &profile);
+
+        double distanceAt(double elapsed) const;
+
+        double speedAt(double elapsed) const;
+
+        RouteSample sampleAtDistance(double distance) const;
+
+        RouteSample sample(double elapsed) const;
+
+        double length() const {
+            return cumulative_.empty() ? 0.0 : cumulative_.back();
+        }
+
+        size_t size() const {
+            return points_.size();
+        }
+
+        bool empty() const {
+            return points_.size() < 2;
+        }
+
+    private:
+        size_t locate(double distance) const;
+
+        std::vector<RoutePoint> points_;
+        std::vector<double> cumulative_; // metres from the first vertex, one per vertex
+        std::vector<double> bearing_;    // radians, one per segment
+        std::vector<double> curvature_;  // rad/m, one per vertex
+        SpeedProfile profile_;
+
+        // Last segment hit; sequential playback almost always lands in it or the next one.
+        mutable std::atomic<size_t> cursor_{0};
+    };
+
+    // Snapshot of the shared playback state, taken once per sensor batch.
+    struct RoutePlayback {
+        std::shared_ptr<const RouteEngine> engine;
+        int64_t startNs = 0;
+        int64_t pausedNs = 0; // boot time the playback was paused at, 0 while running
+
+        bool sample(int64_t timestampNs, RouteSample &out) const;
+    };
+
+    // Shared playback state read by both the sensor hook and the location path.
+    void startRoutePlayback(std::shared_ptr<RouteEngine> engine, int64_t startNs);
+
+    void stopRoutePlayback();
+
+    // Stops the playback once `engine` has reached its end, unless another route was started meanwhile.
+    void finishRoutePlayback(const RouteEngine *engine);
+
+    void pauseRoutePlayback(bool paused, int64_t nowNs);
+
+    bool isRoutePlaying();
+
+    RoutePlayback routePlayback();
+
+    // Samples the current playback and stops it when the end is reached. Used by the location path only,
+    // the sensor hook samples its batch snapshot and never ends the playback, so the end point is not skipped.
+    bool sampleRoutePlayback(int64_t timestampNs, RouteSample &out);
+
+    int64_t bootTimeNs();
+}
+
+#endif //PORTAL_ROUTE_ENGINE_H
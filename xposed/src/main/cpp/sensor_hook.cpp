@@ -4,53 +4,21 @@
 #include "logging.h"
 #include "elf_util.h"
 #include "dobby_hook.h"
+#include "route_engine.h"
+#include "sensor_recorder.h"
+#include "noise.h"
+#include "state_timeline.h"
 #include <fstream>
 #include <string>
 #include <chrono>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
 
 #define LIBSF_PATH "/system/lib64/libsensorservice.so"
 
 extern bool enableSensorHook;
 
-// Standard Android sensors_event_t layout
-typedef struct {
-    int32_t version;
-    int32_t sensor;
-    int32_t type;
-    int32_t reserved0;
-    int64_t timestamp;
-    union {
-        union {
-            float           data[16];
-            uint64_t        step_counter;
-        };
-        union {
-            float           x;
-            float           y;
-            float           z;
-        } acceleration;
-        union {
-            float           x;
-            float           y;
-            float           z;
-        } magnetic;
-        union {
-            float           x;
-            float           y;
-            float           z;
-        } orientation;
-        union {
-            float           x;
-            float           y;
-            float           z;
-        } gyro;
-    };
-    uint32_t flags;
-    uint32_t reserved1[3];
-} sensors_event_t;
-
 // _ZN7android16SensorEventQueue5writeERKNS_2spINS_7BitTubeEEEPK12ASensorEventm
 OriginalSensorEventQueueWriteType OriginalSensorEventQueueWrite = nullptr;
 
@@ -64,6 +32,22 @@ static uint64_t gVirtualSteps = 0;
 static uint64_t gStartTimestamp = 0;
 static uint64_t gLastConfigUpdateTime = 0;
 
+// Three Gaussian samples per event, filled a chunk at a time.
+static constexpr size_t kNoiseChunk = 32;
+static constexpr size_t kNoiseDraws = 4; // independent Gaussians per event, one per axis the event consumes
+
+static void fillSensorNoise(const portal::NoiseGenerator& noise, const sensors_event_t* events, size_t count, float* out) {
+    uint64_t counters[kNoiseChunk * kNoiseDraws];
+    for (size_t i = 0; i < count; i++) {
+        // (timestamp, type, axis) identifies a sample, so replays with the same seed are identical
+        uint64_t base = ((uint64_t)events[i].timestamp << 8) | (((uint64_t)events[i].type & 0x3f) << 2);
+        for (size_t axis = 0; axis < kNoiseDraws; axis++) {
+            counters[i * kNoiseDraws + axis] = base | axis;
+        }
+    }
+    noise.fillGaussian(portal::NOISE_STREAM_SENSOR, counters, out, count * kNoiseDraws);
+}
+
 static uint64_t getCurrentTimeMs() {
     return std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now().time_since_epoch()).count();
@@ -139,13 +123,52 @@ void updateSensorConfig(bool enable, double speed, double bearing) {
 
 
 int64_t SensorEventQueueWrite(void *tube, void *events, int64_t numEvents) {
+    // Record the real batch before any simulation touches it
+    if (numEvents > 0 && portal::isSensorRecording()) {
+        portal::recordSensorEvents((const sensors_event_t*)events, numEvents);
+    }
+
     if (enableSensorHook && events != nullptr) {
         updateConfig();
         
         if (gEnable) {
             sensors_event_t* sensorEvents = (sensors_event_t*)events;
+            // One snapshot per batch; the app may replace the route or the timeline concurrently
+            portal::RoutePlayback route = portal::routePlayback();
+            auto timeline = portal::stateTimeline();
+            portal::NoiseGenerator noise = portal::sessionNoise();
+            float gaussian[kNoiseChunk * kNoiseDraws];
             for (int i = 0; i < numEvents; i++) {
                 sensors_event_t& event = sensorEvents[i];
+                if (i % kNoiseChunk == 0) {
+                    fillSensorNoise(noise, sensorEvents + i, std::min<size_t>(kNoiseChunk, numEvents - i), gaussian);
+                }
+                const float* n = &gaussian[(i % kNoiseChunk) * kNoiseDraws];
+                double t = event.timestamp / 1000000000.0;
+
+                // While a route is playing, speed/heading/turn rate come from the route at the event time.
+                // A finished route holds still at its end; only the location path ends the playback, so that it
+                // still reads the end point once.
+                double speed = gSpeed;
+                double bearing = gBearing;
+                double turnRate = 0.0;
+                portal::RouteSample routeSample;
+                bool onRoute = route.sample(event.timestamp, routeSample);
+                if (onRoute) {
+                    speed = routeSample.speed;
+                    bearing = routeSample.bearing;
+                    // Android gyro z is counter-clockwise positive, route curvature is positive to the right
+                    turnRate = -routeSample.curvature * routeSample.speed;
+                } else if (timeline != nullptr) {
+                    // Otherwise follow the trajectory submitted through nativeSubmitStates
+                    portal::StateSample state = timeline->sample(event.timestamp);
+                    speed = state.speed;
+                    bearing = state.bearing;
+                    // Gait simulation is pedestrian only
+                    if (state.mode == portal::MOTION_IDLE || state.mode == portal::MOTION_VEHICLE) {
+                        speed = 0.0;
+                    }
+                }
                 
                 // Debug log for first event of batch to confirm hook is active
                 if (i == 0) {
@@ -153,50 +176,49 @@ int64_t SensorEventQueueWrite(void *tube, void *events, int64_t numEvents) {
                 }
 
                 if (event.type == 1) { // Accelerometer
-                     if (gSpeed > 0.1) {
-                         double freq = gSpeed * 1.4;
-                         double t = event.timestamp / 1000000000.0;
+                     if (speed > 0.1) {
+                         double freq = speed * 1.4;
                          double phase = t * freq * 2 * M_PI;
-                         double jitter = ((event.timestamp / 1000000) % 97) / 100.0;
-                         
+
                          double baseWave = 2.0 * sin(phase) + 0.5 * sin(2 * phase + 0.5);
-                         double noise = 0.2 * jitter;
-                         
-                         event.acceleration.x = (float)(sin(phase * 0.5) * 0.5 + noise);
-                         event.acceleration.y = (float)(cos(phase * 0.5) * 0.3);
-                         event.acceleration.z = (float)(9.8 + baseWave + noise);
+
+                         event.acceleration.x = (float)(sin(phase * 0.5) * 0.5 + 0.05 * n[0]);
+                         event.acceleration.y = (float)(cos(phase * 0.5) * 0.3 + 0.05 * n[1]);
+                         event.acceleration.z = (float)(9.8 + baseWave + 0.05 * n[2]);
                      }
                 }
                 else if (event.type == 2) { // Magnetic Field
                      if (gEnable) {
-                         double bearingRad = gBearing * M_PI / 180.0;
+                         double bearingRad = bearing * M_PI / 180.0;
                          double magStrength = 40.0;
-                         double jitter = ((event.timestamp / 1000000) % 97) / 1000.0;
+                         // Heading wanders with 1/f noise sampled every 20ms, as hard/soft iron distortion does
+                         double wander = 0.02 * noise.pink(portal::NOISE_STREAM_MAG_WANDER, event.timestamp / 20000000);
                          double sway = 0.0;
-                         if (gSpeed > 0.1) {
-                             double freq = gSpeed * 1.4;
-                             double t = event.timestamp / 1000000000.0;
+                         if (speed > 0.1) {
+                             double freq = speed * 1.4;
                              sway = sin(t * freq * 0.5) * 0.05;
                          }
-                         double localBearing = -bearingRad + sway + jitter;
-                         
-                         event.magnetic.x = (float)(magStrength * sin(localBearing));
-                         event.magnetic.y = (float)(magStrength * cos(localBearing));
-                         event.magnetic.z = (float)(-30.0 + jitter);
+                         double localBearing = -bearingRad + sway + wander + 0.01 * n[3];
+
+                         event.magnetic.x = (float)(magStrength * sin(localBearing) + 0.3 * n[1]);
+                         event.magnetic.y = (float)(magStrength * cos(localBearing) + 0.3 * n[2]);
+                         event.magnetic.z = (float)(-30.0 + 0.3 * n[0]);
                      }
                 }
                 else if (event.type == 4) { // Gyroscope
-                     if (gSpeed > 0.1) {
-                         double freq = gSpeed * 1.4;
+                     if (speed > 0.1) {
+                         double freq = speed * 1.4;
                          double omega = freq * 0.5 * 2 * M_PI;
-                         double t = event.timestamp / 1000000000.0;
                          double amplitude = 0.05;
                          double yawRate = amplitude * omega * cos(omega * t);
-                         double jitter = ((event.timestamp / 1000000) % 53) / 1000.0;
-                         
-                         event.gyro.x = (float)(jitter); 
-                         event.gyro.y = (float)(jitter);
-                         event.gyro.z = (float)(yawRate + jitter);
+                         // White noise on top of a bias that drifts over ~30s
+                         double biasX = 0.002 * noise.drift(portal::NOISE_STREAM_GYRO_BIAS, t, 30.0);
+                         double biasY = 0.002 * noise.drift(portal::NOISE_STREAM_GYRO_BIAS + 1, t, 30.0);
+                         double biasZ = 0.002 * noise.drift(portal::NOISE_STREAM_GYRO_BIAS + 2, t, 30.0);
+
+                         event.gyro.x = (float)(biasX + 0.003 * n[0]);
+                         event.gyro.y = (float)(biasY + 0.003 * n[1]);
+                         event.gyro.z = (float)(yawRate + turnRate + biasZ + 0.003 * n[2]);
                      }
                 }
                 else if (event.type == 19) { // Step Counter
@@ -209,9 +231,9 @@ int64_t SensorEventQueueWrite(void *tube, void *events, int64_t numEvents) {
                      if (gLastStepEventTime == 0) gLastStepEventTime = event.timestamp;
                      
                      double dt = (event.timestamp - gLastStepEventTime) / 1000000000.0; // ns to s
-                     if (dt > 0 && gSpeed > 0.1) {
+                     if (dt > 0 && speed > 0.1) {
                          // Frequency ~ speed * 1.4 (heuristic)
-                         double currentFreq = gSpeed * 1.4;
+                         double currentFreq = speed * 1.4;
                          gStepAccumulator += dt * currentFreq;
                      }
                      
@@ -221,7 +243,7 @@ int64_t SensorEventQueueWrite(void *tube, void *events, int64_t numEvents) {
                      event.step_counter = gVirtualSteps;
                 } 
                 else if (event.type == 18) { // Step Detector
-                     if (gSpeed > 0.5) event.data[0] = 1.0f;
+                     if (speed > 0.5) event.data[0] = 1.0f;
                 }
             }
         }
@@ -7,6 +7,43 @@
 
 #include "android/sensor.h"
 
+// Standard Android sensors_event_t layout
+typedef struct {
+    int32_t version;
+    int32_t sensor;
+    int32_t type;
+    int32_t reserved0;
+    int64_t timestamp;
+    union {
+        union {
+            float           data[16];
+            uint64_t        step_counter;
+        };
+        union {
+            float           x;
+            float           y;
+            float           z;
+        } acceleration;
+        union {
+            float           x;
+            float           y;
+            float           z;
+        } magnetic;
+        union {
+            float           x;
+            float           y;
+            float           z;
+        } orientation;
+        union {
+            float           x;
+            float           y;
+            float           z;
+        } gyro;
+    };
+    uint32_t flags;
+    uint32_t reserved1[3];
+} sensors_event_t;
+
 // ssize_t SensorEventQueue::write(const sp<BitTube>& tube,
 //        ASensorEvent const* events, size_t numEvents)
 typedef int64_t (*OriginalSensorEventQueueWriteType)(void*, void*, int64_t);
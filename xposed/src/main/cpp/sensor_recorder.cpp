@@ -0,0 +1,263 @@
+#include "sensor_recorder.h"
+#include "spsc_ring.h"
+#include "route_engine.h"
+#include "logging.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+namespace portal {
+
+    static constexpr size_t kStagingRecords = 4096; // 160 KiB per write
+    static constexpr auto kDrainInterval = std::chrono::milliseconds(50);
+    static constexpr size_t kHandleSlots = 64;
+
+    struct SensorRecorder {
+        SensorRecorder(int fd, uint64_t typeMask, size_t capacity)
+                : ring(capacity), fd(fd), typeMask(typeMask) {}
+
+        SpscRing<TraceRecord> ring;
+        int fd;
+        uint64_t typeMask;
+        std::thread drainThread;
+        std::atomic<bool> running{true};
+
+        std::atomic_flag producing = ATOMIC_FLAG_INIT;
+
+        // SensorService writes the same event to every connection, only the first copy is kept.
+        // Keyed by sensor handle, so wake-up and uncalibrated siblings of one type stay apart.
+        struct HandleSlot {
+            int32_t handle;
+            bool used;
+            int64_t lastTimestamp;
+        };
+        HandleSlot handles[kHandleSlots] = {};
+
+        // Returns false for a repeat of the last event of this sensor.
+        bool firstCopy(int32_t handle, int64_t timestamp) {
+            auto start = (size_t) ((uint32_t) handle * 2654435761u) % kHandleSlots;
+            for (size_t probe = 0; probe < kHandleSlots; probe++) {
+                HandleSlot &slot = handles[(start + probe) % kHandleSlots];
+                if (!slot.used) {
+                    slot = {handle, true, timestamp};
+                    return true;
+                }
+                if (slot.handle == handle) {
+                    if (timestamp <= slot.lastTimestamp) return false;
+                    slot.lastTimestamp = timestamp;
+                    return true;
+                }
+            }
+            return true; // table full, record without deduplication
+        }
+
+        std::atomic<uint64_t> recorded{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> contended{0};
+        std::atomic<uint64_t> bytesWritten{0};
+    };
+
+    // Serializes start, stop and stats; the hook path never takes it.
+    static std::mutex gControlLock;
+    static RecorderStats gLastStats{};
+    static std::atomic<bool> gRecording{false};
+    static std::atomic<SensorRecorder *> gRecorder{nullptr};
+    static std::atomic<int> gActiveWriters{0};
+
+    static bool writeFully(int fd, const void *data, size_t size) {
+        auto bytes = static_cast<const uint8_t *>(data);
+        while (size > 0) {
+            ssize_t n = ::write(fd, bytes, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            bytes += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    static void drainLoop(SensorRecorder *recorder) {
+        auto staging = std::make_unique<TraceRecord[]>(kStagingRecords);
+        bool failed = false;
+        while (true) {
+            bool running = recorder->running.load(std::memory_order_acquire);
+            size_t count = recorder->ring.pop(staging.get(), kStagingRecords);
+            if (count > 0 && !failed) {
+                size_t size = count * sizeof(TraceRecord);
+                if (writeFully(recorder->fd, staging.get(), size)) {
+                    recorder->bytesWritten.fetch_add(size, std::memory_order_relaxed);
+                } else {
+                    LOGE("Sensor recorder: write failed, errno=%d", errno);
+                    failed = true;
+                }
+            }
+            if (count == kStagingRecords) {
+                continue;
+            }
+            if (!running) {
+                if (recorder->ring.size() == 0) break;
+                continue;
+            }
+            std::this_thread::sleep_for(kDrainInterval);
+        }
+    }
+
+    static bool isPlainFileName(const char *name) {
+        std::string_view view(name);
+        return !view.empty() && view != "." && view.find('/') == std::string_view::npos
+               && view.find("..") == std::string_view::npos;
+    }
+
+    static RecorderStats readStats(const SensorRecorder *recorder) {
+        return {
+                .recorded = recorder->recorded.load(std::memory_order_relaxed),
+                .dropped = recorder->dropped.load(std::memory_order_relaxed),
+                .contended = recorder->contended.load(std::memory_order_relaxed),
+                .bytesWritten = recorder->bytesWritten.load(std::memory_order_relaxed),
+                .recording = false,
+        };
+    }
+
+    bool startSensorRecord(const char *name, uint64_t typeMask, size_t capacity) {
+        // Held across the check and the open, so a second start can never truncate a running trace.
+        std::lock_guard<std::mutex> lock(gControlLock);
+        if (gRecorder.load(std::memory_order_acquire) != nullptr) {
+            LOGE("Sensor recorder: already recording");
+            return false;
+        }
+        if (name == nullptr || !isPlainFileName(name)) {
+            LOGE("Sensor recorder: rejected trace name");
+            return false;
+        }
+        capacity = std::clamp(capacity, kMinRecordCapacity, kMaxRecordCapacity);
+        std::string path = std::string(PORTAL_TRACE_DIR) + name;
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_NOFOLLOW, 0644);
+        if (fd < 0) {
+            LOGE("Sensor recorder: failed to open %s, errno=%d", path.c_str(), errno);
+            return false;
+        }
+        TraceHeader header{
+                .recordSize = sizeof(TraceRecord),
+                .startNs = bootTimeNs(),
+                .typeMask = typeMask,
+        };
+        if (!writeFully(fd, &header, sizeof(header))) {
+            ::close(fd);
+            return false;
+        }
+
+        auto recorder = new SensorRecorder(fd, typeMask, capacity);
+        recorder->bytesWritten.store(sizeof(header), std::memory_order_relaxed);
+        recorder->drainThread = std::thread(drainLoop, recorder);
+
+        gRecorder.store(recorder);
+        gRecording.store(true, std::memory_order_release);
+        LOGI("Sensor recorder: recording to %s, mask=0x%llx, capacity=%zu", path.c_str(), (unsigned long long) typeMask, recorder->ring.capacity());
+        return true;
+    }
+
+    void stopSensorRecord() {
+        std::lock_guard<std::mutex> lock(gControlLock);
+        gRecording.store(false, std::memory_order_release);
+        SensorRecorder *recorder = gRecorder.exchange(nullptr);
+        if (recorder == nullptr) {
+            return;
+        }
+        // Wait for hook threads that already picked up the pointer; pairs with the seq_cst increment in the writers.
+        while (gActiveWriters.load() != 0) {
+            std::this_thread::yield();
+        }
+        recorder->running.store(false, std::memory_order_release);
+        recorder->drainThread.join();
+        ::fsync(recorder->fd);
+        ::close(recorder->fd);
+        gLastStats = readStats(recorder);
+        LOGI("Sensor recorder: stopped, recorded=%llu, dropped=%llu, contended=%llu",
+             (unsigned long long) gLastStats.recorded,
+             (unsigned long long) gLastStats.dropped,
+             (unsigned long long) gLastStats.contended);
+        delete recorder;
+    }
+
+    bool isSensorRecording() {
+        return gRecording.load(std::memory_order_relaxed);
+    }
+
+    static void recordBatch(SensorRecorder *recorder, const sensors_event_t *events, size_t count) {
+        TraceRecord chunk[64];
+        size_t filled = 0;
+        uint64_t recorded = 0;
+        uint64_t dropped = 0;
+        auto flush = [&]() {
+            size_t pushed = recorder->ring.push(chunk, filled);
+            recorded += pushed;
+            dropped += filled - pushed;
+            filled = 0;
+        };
+        for (size_t i = 0; i < count; i++) {
+            const sensors_event_t &event = events[i];
+            auto type = (uint32_t) event.type;
+            if (type >= 64 || !(recorder->typeMask & (1ULL << type))) {
+                continue;
+            }
+            if (!recorder->firstCopy(event.sensor, event.timestamp)) {
+                continue;
+            }
+
+            TraceRecord &record = chunk[filled++];
+            record.timestamp = event.timestamp;
+            record.type = event.type;
+            record.sensor = event.sensor;
+            memcpy(record.values, event.data, sizeof(record.values));
+            if (filled == std::size(chunk)) {
+                flush();
+            }
+        }
+        if (filled > 0) {
+            flush();
+        }
+        if (recorded) recorder->recorded.fetch_add(recorded, std::memory_order_relaxed);
+        if (dropped) recorder->dropped.fetch_add(dropped, std::memory_order_relaxed);
+    }
+
+    void recordSensorEvents(const sensors_event_t *events, size_t count) {
+        if (!gRecording.load(std::memory_order_relaxed) || events == nullptr) {
+            return;
+        }
+        gActiveWriters.fetch_add(1);
+        SensorRecorder *recorder = gRecorder.load();
+        if (recorder != nullptr) {
+            // The ring has a single producer; a concurrent writer drops its batch instead of waiting.
+            if (!recorder->producing.test_and_set(std::memory_order_acquire)) {
+                recordBatch(recorder, events, count);
+                recorder->producing.clear(std::memory_order_release);
+            } else {
+                recorder->contended.fetch_add(count, std::memory_order_relaxed);
+            }
+        }
+        gActiveWriters.fetch_sub(1, std::memory_order_release);
+    }
+
+    RecorderStats sensorRecordStats() {
+        std::lock_guard<std::mutex> lock(gControlLock);
+        SensorRecorder *recorder = gRecorder.load(std::memory_order_acquire);
+        if (recorder == nullptr) {
+            return gLastStats;
+        }
+        RecorderStats stats = readStats(recorder);
+        stats.recording = true;
+        return stats;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef PORTAL_SENSOR_RECORDER_H
+#define PORTAL_SENSOR_RECORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "sensor_hook.h"
+
+namespace portal {
+
+    // Binary replay trace: one TraceHeader followed by fixed size TraceRecords, little endian.
+    constexpr uint32_t kTraceMagic = 0x52545350; // "PSTR"
+    constexpr uint32_t kTraceVersion = 1;
+
+    struct TraceHeader {
+        uint32_t magic = kTraceMagic;
+        uint32_t version = kTraceVersion;
+        uint32_t recordSize;
+        uint32_t reserved = 0;
+        int64_t startNs;
+        uint64_t typeMask;
+    };
+
+    struct TraceRecord {
+        int64_t timestamp;
+        int32_t type;
+        int32_t sensor;
+        float values[6]; // first 24 bytes of the event payload, step_counter stays bit exact
+    };
+
+    static_assert(sizeof(TraceHeader) == 32);
+    static_assert(sizeof(TraceRecord) == 40);
+
+    struct RecorderStats {
+        uint64_t recorded;
+        uint64_t dropped;      // ring was full, the drain thread fell behind
+        uint64_t contended;    // another writer thread held the producer slot
+        uint64_t bytesWritten;
+        bool recording;        // false once stopped, the counters then describe the last session
+    };
+
+    // Traces may only be created directly inside this directory.
+#ifndef PORTAL_TRACE_DIR
+#define PORTAL_TRACE_DIR "/data/local/tmp/"
+#endif
+
+    constexpr size_t kMinRecordCapacity = 1024;
+    constexpr size_t kMaxRecordCapacity = 1 << 18; // 10 MiB of records
+
+    // `name` is a plain file name inside PORTAL_TRACE_DIR, `typeMask` selects sensor types by bit (1 << type)
+    // and `capacity` is the ring size in records, clamped to [kMinRecordCapacity, kMaxRecordCapacity].
+    bool startSensorRecord(const char *name, uint64_t typeMask, size_t capacity);
+
+    void stopSensorRecord();
+
+    bool isSensorRecording();
+
+    // Called from the hook with the original batch, before it is modified.
+    void recordSensorEvents(const sensors_event_t *events, size_t count);
+
+    // Live counters while recording, the final counters of the last session after it stopped.
+    RecorderStats sensorRecordStats();
+}
+
+#endif //PORTAL_SENSOR_RECORDER_H
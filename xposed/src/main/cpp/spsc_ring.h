@@ -0,0 +1,80 @@
+#ifndef PORTAL_SPSC_RING_H
+#define PORTAL_SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace portal {
+
+    // Lock-free single producer / single consumer ring of trivially copyable items.
+    // Capacity is rounded up to a power of two and allocated once.
+    template<typename T>
+    requires(std::is_trivially_copyable_v<T>)
+    class SpscRing {
+    public:
+        explicit SpscRing(size_t capacity) {
+            size_t cap = 1;
+            while (cap < capacity) cap <<= 1;
+            mask_ = cap - 1;
+            items_ = std::make_unique<T[]>(cap);
+        }
+
+        size_t capacity() const {
+            return mask_ + 1;
+        }
+
+        // Producer side. Copies as many items as fit and returns how many were taken.
+        size_t push(const T *items, size_t count) {
+            size_t head = head_.load(std::memory_order_relaxed);
+            size_t tail = tail_.load(std::memory_order_acquire);
+            size_t space = capacity() - (head - tail);
+            if (count > space) count = space;
+            if (count == 0) return 0;
+            copyIn(head, items, count);
+            head_.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        // Consumer side. Copies up to `max` items out and returns how many were read.
+        size_t pop(T *out, size_t max) {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            size_t head = head_.load(std::memory_order_acquire);
+            size_t count = head - tail;
+            if (count > max) count = max;
+            if (count == 0) return 0;
+            copyOut(tail, out, count);
+            tail_.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+        size_t size() const {
+            return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+        }
+
+    private:
+        void copyIn(size_t position, const T *items, size_t count) {
+            size_t start = position & mask_;
+            size_t first = std::min(count, capacity() - start);
+            memcpy(&items_[start], items, first * sizeof(T));
+            memcpy(&items_[0], items + first, (count - first) * sizeof(T));
+        }
+
+        void copyOut(size_t position, T *out, size_t count) const {
+            size_t start = position & mask_;
+            size_t first = std::min(count, capacity() - start);
+            memcpy(out, &items_[start], first * sizeof(T));
+            memcpy(out + first, &items_[0], (count - first) * sizeof(T));
+        }
+
+        std::unique_ptr<T[]> items_;
+        size_t mask_ = 0;
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+    };
+}
+
+#endif //PORTAL_SPSC_RING_H
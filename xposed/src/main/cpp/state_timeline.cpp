@@ -0,0 +1,120 @@
+#include "state_timeline.h"
+#include "route_engine.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+
+namespace portal {
+
+    static constexpr size_t kMaxSamples = 8192;
+    static constexpr int64_t kHistoryNs = 2000000000LL; // samples kept behind "now"
+
+    // Writers build the next timeline outside gTimelineLock, which is only held to copy or swap the pointer.
+    static std::mutex gSubmitLock;
+    static std::mutex gTimelineLock;
+    static std::shared_ptr<const StateTimeline> gTimeline;
+    static std::atomic<bool> gHasStates{false};
+
+    static double lerp(double a, double b, double t) {
+        return a + (b - a) * t;
+    }
+
+    StateSample StateTimeline::sample(int64_t timestampNs) const {
+        if (samples_.empty()) {
+            return {};
+        }
+        if (timestampNs <= samples_.front().timestampNs) {
+            return samples_.front();
+        }
+        if (timestampNs >= samples_.back().timestampNs) {
+            return samples_.back();
+        }
+        auto next = std::upper_bound(samples_.begin(), samples_.end(), timestampNs, [](int64_t ts, const StateSample &s) {
+            return ts < s.timestampNs;
+        });
+        const StateSample &a = *(next - 1);
+        const StateSample &b = *next;
+        double t = (double) (timestampNs - a.timestampNs) / (double) (b.timestampNs - a.timestampNs);
+
+        StateSample out = a;
+        out.timestampNs = timestampNs;
+        out.lat = lerp(a.lat, b.lat, t);
+        out.lon = a.lon + remainder(b.lon - a.lon, 360.0) * t;
+        out.altitude = lerp(a.altitude, b.altitude, t);
+        double bearing = a.bearing + remainder((double) b.bearing - a.bearing, 360.0) * t;
+        bearing = fmod(bearing, 360.0);
+        out.bearing = (float) (bearing < 0 ? bearing + 360.0 : bearing);
+        out.speed = (float) lerp(a.speed, b.speed, t);
+        return out;
+    }
+
+    size_t submitStates(const StateSample *samples, size_t count, bool replace) {
+        if (samples == nullptr || count == 0) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> submit(gSubmitLock);
+        std::shared_ptr<const StateTimeline> current;
+        {
+            std::lock_guard<std::mutex> lock(gTimelineLock);
+            current = gTimeline;
+        }
+
+        std::vector<StateSample> merged;
+        merged.reserve(std::min((current ? current->samples().size() : 0) + count, kMaxSamples));
+
+        // Only the newest sample behind the horizon is kept, so that in-flight sensor batches still find their neighbours.
+        int64_t horizon = bootTimeNs() - kHistoryNs;
+        if (current) {
+            int64_t cutoff = replace ? samples[0].timestampNs : INT64_MAX;
+            for (const StateSample &s: current->samples()) {
+                if (s.timestampNs >= cutoff) break;
+                if (s.timestampNs < horizon && !merged.empty()) {
+                    merged.back() = s;
+                    continue;
+                }
+                merged.push_back(s);
+            }
+        }
+
+        // Once full the rest of the batch is rejected, near-now samples are never evicted for far-future ones.
+        size_t accepted = 0;
+        for (size_t i = 0; i < count && merged.size() < kMaxSamples; i++) {
+            if (!merged.empty() && samples[i].timestampNs <= merged.back().timestampNs) {
+                continue; // timestamps must be strictly increasing
+            }
+            merged.push_back(samples[i]);
+            accepted++;
+        }
+
+        auto next = std::make_shared<const StateTimeline>(std::move(merged));
+        {
+            std::lock_guard<std::mutex> lock(gTimelineLock);
+            gTimeline.swap(next);
+            gHasStates.store(true, std::memory_order_release);
+        }
+        return accepted;
+    }
+
+    void clearStates() {
+        std::lock_guard<std::mutex> submit(gSubmitLock);
+        std::shared_ptr<const StateTimeline> previous;
+        {
+            std::lock_guard<std::mutex> lock(gTimelineLock);
+            gHasStates.store(false, std::memory_order_release);
+            gTimeline.swap(previous);
+        }
+    }
+
+    bool hasStates() {
+        return gHasStates.load(std::memory_order_acquire);
+    }
+
+    std::shared_ptr<const StateTimeline> stateTimeline() {
+        if (!hasStates()) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(gTimelineLock);
+        return gTimeline;
+    }
+}
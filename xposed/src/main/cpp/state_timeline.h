@@ -0,0 +1,61 @@
+#ifndef PORTAL_STATE_TIMELINE_H
+#define PORTAL_STATE_TIMELINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace portal {
+
+    enum MotionMode : int32_t {
+        MOTION_IDLE = 0,
+        MOTION_WALK = 1,
+        MOTION_RUN = 2,
+        MOTION_VEHICLE = 3,
+    };
+
+    // Wire format of one sample in the byte array handed over by nativeSubmitStates,
+    // little endian, timestamps on the CLOCK_BOOTTIME (elapsedRealtimeNanos) base.
+    struct StateSample {
+        int64_t timestampNs;
+        double lat;
+        double lon;
+        double altitude;
+        float bearing; // degrees
+        float speed;   // m/s
+        int32_t mode;  // MotionMode
+        int32_t reserved;
+    };
+
+    static_assert(sizeof(StateSample) == 48);
+
+    class StateTimeline {
+    public:
+        explicit StateTimeline(std::vector<StateSample> samples) : samples_(std::move(samples)) {}
+
+        // Linear interpolation between the samples around `timestampNs`, held at both ends.
+        StateSample sample(int64_t timestampNs) const;
+
+        const std::vector<StateSample> &samples() const {
+            return samples_;
+        }
+
+    private:
+        std::vector<StateSample> samples_;
+    };
+
+    // Appends `count` samples; with `replace` the future past the first new sample is dropped first.
+    // History older than two seconds is dropped before the batch, and the tail of the batch is cut off
+    // once the timeline is full. Returns how many samples were actually kept.
+    size_t submitStates(const StateSample *samples, size_t count, bool replace);
+
+    void clearStates();
+
+    bool hasStates();
+
+    // Snapshot of the timeline, stays valid while held even if new samples are submitted.
+    std::shared_ptr<const StateTimeline> stateTimeline();
+}
+
+#endif //PORTAL_STATE_TIMELINE_H
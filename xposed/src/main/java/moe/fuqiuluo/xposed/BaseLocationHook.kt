@@ -29,6 +29,8 @@ abstract class BaseLocationHook: BaseDivineService() {
         if (!FakeLoc.enable)
             return originLocation
 
+        FakeLoc.syncNativeLocation()
+
         if (originLocation.latitude + originLocation.longitude == FakeLoc.latitude + FakeLoc.longitude) {
             // Already processed
             return originLocation
@@ -142,6 +142,58 @@ class FakeLocation: IXposedHookLoadPackage, IXposedHookZygoteInit {
     external fun nativeInitHook()
     external fun nativeUpdateConfig(enable: Boolean, speed: Double, bearing: Double)
 
+    /**
+     * @param points lat/lon pairs laid out as [lat0, lon0, lat1, lon1, ...]
+     * @param smoothing Catmull-Rom subdivisions per segment, 0 to disable, clamped natively to [0, 16]
+     */
+    external fun nativeLoadRoute(points: DoubleArray, speed: Double, speedVariation: Double, smoothing: Int): Boolean
+    external fun nativeStopRoute()
+    external fun nativePauseRoute(paused: Boolean)
+
+    /**
+     * Fills [out] with [lat, lon, bearing, speed, curvature, distance, finished]
+     */
+    external fun nativeSampleRoute(out: DoubleArray): Boolean
+
+    /**
+     * Records the unmodified sensor events of the selected types into a binary replay trace
+     * @param name plain file name, the trace is always created in /data/local/tmp
+     * @param typeMask bit (1 << sensorType) for every type to record
+     * @param capacity ring buffer size in records, clamped natively to [1024, 262144]
+     */
+    external fun nativeStartSensorRecord(name: String, typeMask: Long, capacity: Int): Boolean
+    external fun nativeStopSensorRecord()
+
+    /**
+     * Fills [out] with [recorded, dropped, contended, bytesWritten]; after a stop these are the final counters of that session
+     * @return whether a recording is running
+     */
+    external fun nativeSensorRecordStats(out: LongArray): Boolean
+
+    /**
+     * Seeds the counter-based noise shared by the sensor hook and the location path, 0 picks a fresh one
+     */
+    external fun nativeSetNoiseSeed(seed: Long)
+    external fun nativeGetNoiseSeed(): Long
+
+    /**
+     * Fills [out] with Gaussian samples indexed by counter..counter+out.size-1 on the given location stream
+     */
+    external fun nativeGaussianNoise(stream: Long, counter: Long, out: FloatArray): Boolean
+
+    /**
+     * Enqueues the packed [moe.fuqiuluo.xposed.utils.MockState] samples in [states] into the native timeline
+     * @param replace drop the already queued samples from the first new timestamp on
+     * @return number of samples kept, the tail of the batch is rejected once the timeline is full
+     */
+    external fun nativeSubmitStates(states: ByteArray, replace: Boolean): Int
+    external fun nativeClearStates()
+
+    /**
+     * Fills [out] with the timeline interpolated at now: [lat, lon, altitude, bearing, speed, mode]
+     */
+    external fun nativeSampleState(out: DoubleArray): Boolean
+
     companion object {
         var instance: FakeLocation? = null
     }
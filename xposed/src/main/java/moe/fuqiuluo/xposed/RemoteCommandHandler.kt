@@ -9,6 +9,7 @@ import moe.fuqiuluo.xposed.hooks.LocationServiceHook
 import moe.fuqiuluo.xposed.utils.FakeLoc
 import moe.fuqiuluo.xposed.utils.BinderUtils
 import moe.fuqiuluo.xposed.utils.Logger
+import moe.fuqiuluo.xposed.utils.MockState
 import java.util.Collections
 import kotlin.random.Random
 
@@ -81,6 +82,10 @@ object RemoteCommandHandler {
             "stop" -> {
                 FakeLoc.enable = false
                 FakeLoc.hasBearings = false
+                FakeLoc.enableRoute = false
+                kotlin.runCatching { FakeLocation.instance?.nativeStopRoute() }
+                FakeLoc.enableTimeline = false
+                kotlin.runCatching { FakeLocation.instance?.nativeClearStates() }
                 if (isLoadedLibrary) {
                     Dobby.setStatus(false)
                 }
@@ -115,7 +120,103 @@ object RemoteCommandHandler {
                 FakeLoc.enableMockWifi = false
                 return true
             }
+            "start_route" -> {
+                val route = rely.getDoubleArray("route") ?: return false
+                val speed = rely.getDouble("speed", FakeLoc.speed)
+                val speedVariation = rely.getDouble("speed_variation", 0.0)
+                val smoothing = rely.getInt("smoothing", 0)
+                val fakeLocation = FakeLocation.instance ?: return false
+                val loaded = kotlin.runCatching {
+                    fakeLocation.nativeLoadRoute(route, speed, speedVariation, smoothing)
+                }.onFailure {
+                    Logger.error("Failed to load route", it)
+                }.getOrDefault(false)
+                FakeLoc.enableRoute = loaded
+                if (loaded) {
+                    FakeLoc.speed = speed
+                    FakeLoc.syncRouteLocation()
+                }
+                return loaded
+            }
+            "stop_route" -> {
+                FakeLoc.enableRoute = false
+                kotlin.runCatching { FakeLocation.instance?.nativeStopRoute() }
+                return true
+            }
+            "pause_route" -> {
+                val paused = rely.getBoolean("paused", true)
+                kotlin.runCatching { FakeLocation.instance?.nativePauseRoute(paused) }
+                return true
+            }
+            "is_route_start" -> {
+                rely.putBoolean("is_route_start", FakeLoc.syncRouteLocation())
+                return true
+            }
+            "submit_states" -> {
+                val states = rely.getByteArray("states") ?: return false
+                val replace = rely.getBoolean("replace", true)
+                if (states.size < MockState.SIZE_BYTES) return false
+                val fakeLocation = FakeLocation.instance ?: return false
+                val accepted = kotlin.runCatching {
+                    fakeLocation.nativeSubmitStates(states, replace)
+                }.onFailure {
+                    Logger.error("Failed to submit states", it)
+                }.getOrDefault(0)
+                if (accepted > 0) {
+                    FakeLoc.enableTimeline = true
+                }
+                rely.putInt("accepted", accepted)
+                return true
+            }
+            "clear_states" -> {
+                // 停在当前插值位置，之后的手动定位不再被时间线覆盖
+                FakeLoc.syncTimelineLocation()
+                FakeLoc.enableTimeline = false
+                kotlin.runCatching { FakeLocation.instance?.nativeClearStates() }
+                return true
+            }
+            "start_sensor_record" -> {
+                // A plain file name inside /data/local/tmp, validated natively along with the capacity
+                val name = rely.getString("name") ?: "portal_sensor.trace"
+                // accelerometer, magnetic field, gyroscope, step detector, step counter
+                val typeMask = rely.getLong("type_mask", (1L shl 1) or (1L shl 2) or (1L shl 4) or (1L shl 18) or (1L shl 19))
+                val capacity = rely.getInt("capacity", 65536)
+                val fakeLocation = FakeLocation.instance ?: return false
+                return kotlin.runCatching {
+                    fakeLocation.nativeStartSensorRecord(name, typeMask, capacity)
+                }.onFailure {
+                    Logger.error("Failed to start sensor record", it)
+                }.getOrDefault(false)
+            }
+            "stop_sensor_record" -> {
+                kotlin.runCatching { FakeLocation.instance?.nativeStopSensorRecord() }
+                return true
+            }
+            "get_sensor_record_stats" -> {
+                val stats = LongArray(4)
+                val recording = kotlin.runCatching {
+                    FakeLocation.instance?.nativeSensorRecordStats(stats) ?: false
+                }.getOrDefault(false)
+                rely.putBoolean("recording", recording)
+                rely.putLong("recorded", stats[0])
+                rely.putLong("dropped", stats[1])
+                rely.putLong("contended", stats[2])
+                rely.putLong("bytes_written", stats[3])
+                return true
+            }
+            "set_noise_seed" -> {
+                val seed = rely.getLong("seed", 0L)
+                kotlin.runCatching { FakeLocation.instance?.nativeSetNoiseSeed(seed) }
+                FakeLoc.resetNoiseSequence()
+                return true
+            }
+            "get_noise_seed" -> {
+                val seed = kotlin.runCatching { FakeLocation.instance?.nativeGetNoiseSeed() }.getOrNull() ?: return false
+                rely.putLong("seed", seed)
+                return true
+            }
             "get_location" -> {
+                FakeLoc.syncNativeLocation()
                 rely.putDouble("lat", FakeLoc.latitude)
                 rely.putDouble("lon", FakeLoc.longitude)
                 return true
@@ -276,6 +377,7 @@ object RemoteCommandHandler {
                 return true
             }
             "broadcast_location" -> {
+                FakeLoc.syncNativeLocation()
                 LocationServiceHook.callOnLocationChanged()
                 return true
             }
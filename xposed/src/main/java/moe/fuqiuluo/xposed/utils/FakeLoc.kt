@@ -1,7 +1,9 @@
 package moe.fuqiuluo.xposed.utils
 
 import android.location.Location
+import java.util.concurrent.atomic.AtomicLong
 import kotlin.math.PI
+import kotlin.math.abs
 import kotlin.math.atan2
 import kotlin.math.cos
 import kotlin.math.pow
@@ -129,6 +131,73 @@ object FakeLoc {
             }
         }
 
+    /**
+     * 路线由Native引擎播放，位置/方向/速度以Native为准
+     */
+    @Volatile
+    var enableRoute = false
+
+    private val routeSample = DoubleArray(7)
+
+    /**
+     * 从Native路线引擎同步当前位置，返回路线是否仍在播放
+     */
+    fun syncRouteLocation(): Boolean {
+        if (!enableRoute) return false
+        val fakeLocation = moe.fuqiuluo.xposed.FakeLocation.instance ?: return false
+        synchronized(routeSample) {
+            val sampled = kotlin.runCatching { fakeLocation.nativeSampleRoute(routeSample) }.getOrDefault(false)
+            if (!sampled) {
+                // 路线已被停止；终点只由这里结束，传感器Hook不会提前清除
+                enableRoute = false
+                return false
+            }
+            latitude = routeSample[0]
+            longitude = routeSample[1]
+            bearing = routeSample[2]
+            hasBearings = true
+            speed = routeSample[3]
+            if (routeSample[6] != 0.0) {
+                // Native在返回终点样本时已停止播放
+                enableRoute = false
+            }
+        }
+        return enableRoute
+    }
+
+    /**
+     * 状态时间线由App批量提交，位置/方向/速度以Native插值为准
+     */
+    @Volatile
+    var enableTimeline = false
+
+    private val timelineSample = DoubleArray(6)
+
+    fun syncTimelineLocation(): Boolean {
+        if (!enableTimeline) return false
+        val fakeLocation = moe.fuqiuluo.xposed.FakeLocation.instance ?: return false
+        synchronized(timelineSample) {
+            val sampled = kotlin.runCatching { fakeLocation.nativeSampleState(timelineSample) }.getOrDefault(false)
+            if (!sampled) return false
+            latitude = timelineSample[0]
+            longitude = timelineSample[1]
+            altitude = timelineSample[2]
+            bearing = timelineSample[3]
+            hasBearings = true
+            speed = timelineSample[4]
+        }
+        return true
+    }
+
+    /**
+     * 路线优先，其次是状态时间线
+     */
+    fun syncNativeLocation() {
+        if (!syncRouteLocation()) {
+            syncTimelineLocation()
+        }
+    }
+
     fun haversine(lat1: Double, lon1: Double, lat2: Double, lon2: Double): Double {
         val radius = 6371000.0
         val phi1 = Math.toRadians(lat1)
@@ -140,11 +209,38 @@ object FakeLoc {
         return radius * c
     }
 
-    fun jitterLocation(lat: Double = latitude, lon: Double = longitude, n: Double = Random.nextDouble(0.0, accuracy.toDouble()), angle: Double = bearing): Pair<Double, Double> {
+    /**
+     * 定位噪声的序号，设置种子时归零，使同一种子下的第N次抖动结果固定
+     */
+    private val noiseSequence = AtomicLong(0)
+
+    fun resetNoiseSequence() {
+        noiseSequence.set(0)
+    }
+
+    /**
+     * 由Native计数器噪声生成，以调用序号为计数器，同一种子下结果可复现；Native不可用时退回Random
+     */
+    private fun locationNoise(): FloatArray? {
+        val fakeLocation = moe.fuqiuluo.xposed.FakeLocation.instance ?: return null
+        val noise = FloatArray(2)
+        // 每次取两个高斯值，计数器按2递增避免相邻两次重叠
+        val counter = noiseSequence.getAndIncrement() * 2
+        val filled = kotlin.runCatching { fakeLocation.nativeGaussianNoise(0, counter, noise) }.getOrDefault(false)
+        return if (filled) noise else null
+    }
+
+    fun jitterLocation(lat: Double = latitude, lon: Double = longitude, n: Double? = null, angle: Double = bearing): Pair<Double, Double> {
+        val noise = locationNoise()
+        val radius = n ?: noise?.let {
+            (abs(it[0]) * accuracy / 2).coerceAtMost(accuracy.toDouble())
+        } ?: Random.nextDouble(0.0, accuracy.toDouble())
+
         val earthRadius = 6371000.0
-        val radiusInDegrees = n / 15 / earthRadius * (180 / PI)
+        val radiusInDegrees = radius / 15 / earthRadius * (180 / PI)
 
-        val jitterAngle = if (Random.nextBoolean()) angle + 45 else angle - 45
+        val turnLeft = noise?.let { it[1] < 0 } ?: Random.nextBoolean()
+        val jitterAngle = if (turnLeft) angle + 45 else angle - 45
 
         val newLat = lat + radiusInDegrees * cos(Math.toRadians(jitterAngle))
         val newLon = lon + radiusInDegrees * sin(Math.toRadians(jitterAngle)) / cos(Math.toRadians(lat))
@@ -0,0 +1,46 @@
+package moe.fuqiuluo.xposed.utils
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * 一个带时间戳的模拟状态，批量提交给Native时间线后由传感器Hook按事件时间插值
+ *
+ * @param elapsedRealtimeNanos 与SystemClock.elapsedRealtimeNanos()同一时基
+ */
+data class MockState(
+    val elapsedRealtimeNanos: Long,
+    val latitude: Double,
+    val longitude: Double,
+    val altitude: Double,
+    val bearing: Float,
+    val speed: Float,
+    val mode: Int = MODE_WALK
+) {
+    companion object {
+        const val MODE_IDLE = 0
+        const val MODE_WALK = 1
+        const val MODE_RUN = 2
+        const val MODE_VEHICLE = 3
+
+        /**
+         * 与Native的StateSample布局一致（小端，48字节）
+         */
+        const val SIZE_BYTES = 48
+
+        fun pack(states: List<MockState>): ByteArray {
+            val buffer = ByteBuffer.allocate(states.size * SIZE_BYTES).order(ByteOrder.LITTLE_ENDIAN)
+            states.forEach {
+                buffer.putLong(it.elapsedRealtimeNanos)
+                buffer.putDouble(it.latitude)
+                buffer.putDouble(it.longitude)
+                buffer.putDouble(it.altitude)
+                buffer.putFloat(it.bearing)
+                buffer.putFloat(it.speed)
+                buffer.putInt(it.mode)
+                buffer.putInt(0)
+            }
+            return buffer.array()
+        }
+    }
+}